@@ -0,0 +1,242 @@
+// BandSplitBank.h
+#pragma once
+#include <JuceHeader.h>
+#include "HilbertIirAllpass.h"
+
+//==============================================================================
+// Band-split Hilbert detector bank
+//
+// Splits the input into 2..8 bands with a Linkwitz-Riley (LR4) crossover
+// tree. Every band is flattened into its own cascade of biquads: the high
+// passes of the crossovers below it, its low pass, and the allpasses that
+// compensate the crossovers above it, so the bands sum back to an allpassed
+// copy of the input. Each band then goes through the IIR allpass Hilbert
+// pair for its envelope.
+//
+// The bands run side by side in SIMD lanes: every lane sees the same input
+// sample and only the coefficients differ, so a group of numLanes bands costs
+// about as much as one. In double precision a register holds half as many
+// bands, so the bank runs twice as many groups.
+//==============================================================================
+template <typename SampleType>
+class BandSplitBank
+{
+public:
+    using Lanes = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int numLanes = static_cast<int>(Lanes::SIMDNumElements);
+    static constexpr int maxBands = 8;
+
+    void prepare(double newSampleRate, int numChannels)
+    {
+        sampleRate = newSampleRate;
+        channels.resize(static_cast<size_t>(juce::jmax(1, numChannels)));
+
+        for (int s = 0; s < HilbertIirAllpass::numSections; ++s)
+        {
+            realHilbert[static_cast<size_t>(s)] = Lanes::expand(HilbertIirAllpass::realCoeffs<SampleType>[static_cast<size_t>(s)]);
+            imagHilbert[static_cast<size_t>(s)] = Lanes::expand(HilbertIirAllpass::imagCoeffs<SampleType>[static_cast<size_t>(s)]);
+        }
+
+        numBands = 0;
+        setNumBands(maxBands);
+    }
+
+    void reset()
+    {
+        std::fill(channels.begin(), channels.end(), ChannelState{});
+    }
+
+    // Redesigns the crossovers (no allocation) and clears the band states
+    void setNumBands(int newNumBands)
+    {
+        newNumBands = juce::jlimit(2, maxBands, newNumBands);
+        if (newNumBands == numBands)
+            return;
+
+        numBands = newNumBands;
+        numSections = 2 * numBands - 2;
+        design();
+        reset();
+    }
+
+    int getNumBands() const { return numBands; }
+
+    // Crossovers are spaced geometrically from 100 Hz to 6.4 kHz
+    static double getCrossoverFrequency(int index, int numBands)
+    {
+        return numBands > 2 ? 100.0 * std::pow(64.0, index / static_cast<double>(numBands - 2)) : 800.0;
+    }
+
+    // Splits numSamples of one channel into bands[0..numBands) and writes the
+    // instantaneous envelope of each band to envelopes[0..numBands)
+    void process(int channel, const SampleType* input, SampleType* const* bands, SampleType* const* envelopes, int numSamples)
+    {
+        jassert(juce::isPositiveAndBelow(channel, static_cast<int>(channels.size())));
+        auto& state = channels[static_cast<size_t>(channel)];
+
+        alignas(Lanes::SIMDRegisterSize) SampleType bandValues[numLanes];
+        alignas(Lanes::SIMDRegisterSize) SampleType powerValues[numLanes];
+
+        for (int g = 0; g * numLanes < numBands; ++g)
+        {
+            auto& group = state.groups[static_cast<size_t>(g)];
+            const auto& sections = coefficients[static_cast<size_t>(g)];
+            const int firstBand = g * numLanes;
+            const int numGroupBands = juce::jmin(numLanes, numBands - firstBand);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                // Crossover cascade, transposed direct form II
+                auto x = Lanes::expand(input[i]);
+                for (int s = 0; s < numSections; ++s)
+                {
+                    auto& section = group.crossover[static_cast<size_t>(s)];
+                    const auto& c = sections[static_cast<size_t>(s)];
+                    const auto y = c.b0 * x + section.s1;
+                    section.s1 = c.b1 * x - c.a1 * y + section.s2;
+                    section.s2 = c.b2 * x - c.a2 * y;
+                    x = y;
+                }
+
+                // |band + j H{band}|^2, the real chain carrying the extra sample of delay
+                const auto real = group.realDelay;
+                group.realDelay = processHilbertChain(group.real, realHilbert, x);
+                const auto imag = processHilbertChain(group.imag, imagHilbert, x);
+                const auto power = real * real + imag * imag;
+
+                x.copyToRawArray(bandValues);
+                power.copyToRawArray(powerValues);
+                for (int lane = 0; lane < numGroupBands; ++lane)
+                {
+                    bands[firstBand + lane][i] = bandValues[lane];
+                    envelopes[firstBand + lane][i] = std::sqrt(powerValues[lane]);
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr int maxGroups = (maxBands + numLanes - 1) / numLanes;
+    static constexpr int maxSections = 2 * maxBands - 2;
+    using HilbertLanes = std::array<Lanes, HilbertIirAllpass::numSections>;
+
+    struct Biquad
+    {
+        Lanes b0, b1, b2, a1, a2;
+    };
+
+    struct BiquadState
+    {
+        Lanes s1, s2;
+    };
+
+    struct AllpassState
+    {
+        Lanes x1, x2, y1, y2;
+    };
+
+    struct GroupState
+    {
+        std::array<BiquadState, maxSections> crossover;
+        std::array<AllpassState, HilbertIirAllpass::numSections> real;
+        std::array<AllpassState, HilbertIirAllpass::numSections> imag;
+        Lanes realDelay;
+    };
+
+    struct ChannelState
+    {
+        std::array<GroupState, maxGroups> groups;
+    };
+
+    enum class SectionType { lowPass, highPass, allPass };
+
+    static Lanes processHilbertChain(std::array<AllpassState, HilbertIirAllpass::numSections>& chain,
+                                     const HilbertLanes& coeffs, Lanes x)
+    {
+        for (size_t s = 0; s < chain.size(); ++s)
+        {
+            auto& section = chain[s];
+            const auto y = coeffs[s] * (x + section.y2) - section.x2;
+
+            section.x2 = section.x1;
+            section.x1 = x;
+            section.y2 = section.y1;
+            section.y1 = y;
+            x = y;
+        }
+
+        return x;
+    }
+
+    void design()
+    {
+        // Unused sections and lanes pass the signal through unchanged
+        for (auto& group : coefficients)
+            for (auto& section : group)
+                section = { Lanes::expand(1), Lanes::expand(0), Lanes::expand(0),
+                            Lanes::expand(0), Lanes::expand(0) };
+
+        const int numCrossovers = numBands - 1;
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            int section = 0;
+
+            // LR4 high passes of the crossovers below this band
+            for (int c = 0; c < juce::jmin(band, numCrossovers); ++c)
+            {
+                setSection(band, section++, SectionType::highPass, c);
+                setSection(band, section++, SectionType::highPass, c);
+            }
+
+            if (band < numCrossovers)
+            {
+                // LR4 low pass of its own crossover, then allpasses matching
+                // the phase of the crossovers above it
+                setSection(band, section++, SectionType::lowPass, band);
+                setSection(band, section++, SectionType::lowPass, band);
+
+                for (int c = band + 1; c < numCrossovers; ++c)
+                    setSection(band, section++, SectionType::allPass, c);
+            }
+
+            jassert(section <= numSections);
+        }
+    }
+
+    // Second-order Butterworth (Q = 1/sqrt2) sections from the bilinear
+    // transform; LP^2 + HP^2 is then exactly the allpass used for compensation
+    void setSection(int band, int section, SectionType type, int crossover)
+    {
+        const double frequency = juce::jmin(getCrossoverFrequency(crossover, numBands), 0.45 * sampleRate);
+        const double w0 = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+        const double cosW0 = std::cos(w0);
+        const double alpha = std::sin(w0) * juce::MathConstants<double>::sqrt2 * 0.5;
+
+        double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+        switch (type)
+        {
+        case SectionType::lowPass:  b0 = b2 = (1.0 - cosW0) * 0.5; b1 = 1.0 - cosW0; break;
+        case SectionType::highPass: b0 = b2 = (1.0 + cosW0) * 0.5; b1 = -(1.0 + cosW0); break;
+        case SectionType::allPass:  b0 = 1.0 - alpha; b1 = -2.0 * cosW0; b2 = 1.0 + alpha; break;
+        }
+
+        const double a0 = 1.0 + alpha;
+        auto& c = coefficients[static_cast<size_t>(band / numLanes)][static_cast<size_t>(section)];
+        const auto lane = static_cast<size_t>(band % numLanes);
+
+        c.b0.set(lane, static_cast<SampleType>(b0 / a0));
+        c.b1.set(lane, static_cast<SampleType>(b1 / a0));
+        c.b2.set(lane, static_cast<SampleType>(b2 / a0));
+        c.a1.set(lane, static_cast<SampleType>(-2.0 * cosW0 / a0));
+        c.a2.set(lane, static_cast<SampleType>((1.0 - alpha) / a0));
+    }
+
+    std::array<std::array<Biquad, maxSections>, maxGroups> coefficients;
+    HilbertLanes realHilbert;
+    HilbertLanes imagHilbert;
+    std::vector<ChannelState> channels;
+    double sampleRate = 44100.0;
+    int numBands = 0;
+    int numSections = 0;
+};
@@ -0,0 +1,46 @@
+// CachedLayer.h
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+// Static component layer rendered once into an image
+//
+// The layer is re-rendered lazily when the component's size or display scale
+// changes (or after invalidate()), otherwise paint() just blits the image.
+//==============================================================================
+class CachedLayer
+{
+public:
+    void invalidate() { image = {}; }
+
+    template <typename Painter>
+    void draw(juce::Graphics& g, juce::Component& component, Painter&& painter)
+    {
+        const float scale = juce::Component::getApproximateScaleFactorForComponent(&component);
+        const auto bounds = component.getLocalBounds();
+
+        if (image.isNull() || scale != renderedScale || bounds.getWidth() != renderedWidth
+            || bounds.getHeight() != renderedHeight)
+        {
+            renderedScale = scale;
+            renderedWidth = bounds.getWidth();
+            renderedHeight = bounds.getHeight();
+
+            image = juce::Image(juce::Image::ARGB,
+                juce::jmax(1, juce::roundToInt(renderedWidth * scale)),
+                juce::jmax(1, juce::roundToInt(renderedHeight * scale)), true);
+
+            juce::Graphics imageGraphics(image);
+            imageGraphics.addTransform(juce::AffineTransform::scale(scale));
+            painter(imageGraphics);
+        }
+
+        g.drawImage(image, bounds.toFloat());
+    }
+
+private:
+    juce::Image image;
+    float renderedScale = 0.0f;
+    int renderedWidth = 0;
+    int renderedHeight = 0;
+};
@@ -0,0 +1,94 @@
+// ControlRateOutput.h
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+// Decimated control-rate envelope output
+//
+// Reduces the detector envelope to one 7-bit value per control period (the
+// period's maximum, so short transients still register) and only emits it
+// when it has moved by at least the threshold. The events of one block are
+// collected in a fixed array for the processor to turn into MIDI CCs and a
+// parameter update; if a block would overflow it, the newest event replaces
+// the last one. The cap bounds the MIDI a block can add, so callers can
+// reserve the MidiBuffer up front (see maxMidiBytesPerBlock).
+//==============================================================================
+class ControlRateOutput
+{
+public:
+    static constexpr int maxEventsPerBlock = 256;
+
+    // MidiBuffer storage for a full block of CCs: each event is stored as a
+    // 32-bit timestamp, a 16-bit size and the 3 message bytes
+    static constexpr int maxMidiBytesPerBlock = maxEventsPerBlock
+        * static_cast<int>(sizeof(juce::int32) + sizeof(juce::uint16) + 3);
+
+    struct Event
+    {
+        int sampleOffset = 0;  // within the current block
+        int value = 0;         // 0..127
+    };
+
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        periodMax = 0.0f;
+        periodCount = 0;
+        lastValue = -1;
+        numEvents = 0;
+    }
+
+    // Call before the block's first pushSample()
+    void beginBlock(float rateHz, int thresholdSteps)
+    {
+        interval = juce::jmax(1, juce::roundToInt(sampleRate / juce::jmax(1.0f, rateHz)));
+        threshold = juce::jmax(1, thresholdSteps);
+        numEvents = 0;
+        position = 0;
+    }
+
+    void pushSample(float envelope)
+    {
+        periodMax = juce::jmax(periodMax, envelope);
+
+        if (++periodCount >= interval)
+        {
+            emit(periodMax);
+            periodMax = 0.0f;
+            periodCount = 0;
+        }
+
+        ++position;
+    }
+
+    int getNumEvents() const { return numEvents; }
+    const Event& getEvent(int index) const { return events[static_cast<size_t>(index)]; }
+
+    // Most recently emitted value (0..127), -1 before the first one
+    int getLastValue() const { return lastValue; }
+
+private:
+    void emit(float value)
+    {
+        const int quantised = juce::jlimit(0, 127, juce::roundToInt(value * 127.0f));
+        if (lastValue >= 0 && std::abs(quantised - lastValue) < threshold)
+            return;
+
+        lastValue = quantised;
+
+        if (numEvents == maxEventsPerBlock)
+            --numEvents;
+
+        events[static_cast<size_t>(numEvents++)] = { position, quantised };
+    }
+
+    std::array<Event, maxEventsPerBlock> events;
+    double sampleRate = 44100.0;
+    int interval = 441;
+    int threshold = 1;
+    int numEvents = 0;
+    int position = 0;
+    float periodMax = 0.0f;
+    int periodCount = 0;
+    int lastValue = -1;
+};
@@ -0,0 +1,87 @@
+// DspDispatch.cpp
+#include "DspDispatch.h"
+
+namespace
+{
+    std::atomic<int> forcedVariant{ -1 };
+
+    bool detectSupport(DspDispatch::Variant variant)
+    {
+        switch (variant)
+        {
+        case DspDispatch::baseline: return true;
+       #if HILBERT_DISPATCH_X86
+        case DspDispatch::avx2: return juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+        case DspDispatch::avx512: return juce::SystemStats::hasAVX512F() && juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+       #endif
+        default: return false;
+        }
+    }
+}
+
+namespace DspDispatch
+{
+    juce::String getVariantName(Variant variant)
+    {
+        switch (variant)
+        {
+        case avx2: return "AVX2";
+        case avx512: return "AVX-512";
+        default: break;
+        }
+
+       #if JUCE_INTEL
+        return "SSE2";
+       #elif JUCE_ARM && JUCE_USE_ARM_NEON
+        return "NEON";
+       #else
+        return "Generic";
+       #endif
+    }
+
+    bool isSupported(Variant variant)
+    {
+        // cpuid only needs asking once
+        static const auto supported = []
+        {
+            std::array<bool, numVariants> result{};
+            for (int v = 0; v < numVariants; ++v)
+                result[static_cast<size_t>(v)] = detectSupport(static_cast<Variant>(v));
+            return result;
+        }();
+
+        return juce::isPositiveAndBelow(static_cast<int>(variant), static_cast<int>(numVariants))
+            && supported[static_cast<size_t>(variant)];
+    }
+
+    Variant getBestVariant()
+    {
+        for (int variant = numVariants - 1; variant > baseline; --variant)
+            if (isSupported(static_cast<Variant>(variant)))
+                return static_cast<Variant>(variant);
+
+        return baseline;
+    }
+
+    Variant getActiveVariant()
+    {
+        const int forced = forcedVariant.load();
+        return forced >= 0 ? static_cast<Variant>(forced) : getBestVariant();
+    }
+
+    void forceVariant(Variant variant)
+    {
+        if (!isSupported(variant))
+        {
+            jassertfalse;
+            return;
+        }
+
+        forcedVariant = static_cast<int>(variant);
+    }
+
+    void clearForcedVariant()
+    {
+        forcedVariant = -1;
+    }
+}
@@ -0,0 +1,68 @@
+// DspDispatch.h
+#pragma once
+#include <JuceHeader.h>
+
+// ISA-specific kernel builds need per-function target attributes, which only
+// GCC and Clang provide. Elsewhere (or with HILBERT_DISABLE_DISPATCH defined)
+// every kernel runs its baseline build.
+#if JUCE_INTEL && (JUCE_GCC || JUCE_CLANG) && ! defined (HILBERT_DISABLE_DISPATCH)
+ #define HILBERT_DISPATCH_X86 1
+ #define HILBERT_TARGET_AVX2 __attribute__((target("avx2,fma")))
+ #define HILBERT_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#else
+ #define HILBERT_DISPATCH_X86 0
+#endif
+
+//==============================================================================
+// Runtime CPU dispatch for the DSP kernels
+//
+// The hot loops (Hilbert FIR, envelope follower, fast tanh) are compiled once
+// per instruction set: the baseline for the build target (SSE2 on x86-64,
+// NEON on AArch64) plus AVX2 and AVX-512 builds on x86. The CPU is checked
+// once per process; each kernel owner resolves its function pointers in
+// prepare(), so the audio thread only makes indirect calls.
+//
+// forceVariant() overrides the choice for the next prepare() calls. It is
+// meant for tools comparing the variants' output, not for the plugin.
+//==============================================================================
+namespace DspDispatch
+{
+    enum Variant
+    {
+        baseline = 0,
+        avx2,
+        avx512,
+        numVariants
+    };
+
+    juce::String getVariantName(Variant variant);
+
+    // Compiled in and available on this CPU
+    bool isSupported(Variant variant);
+
+    // The fastest supported variant
+    Variant getBestVariant();
+
+    // The forced variant if there is one, the best otherwise
+    Variant getActiveVariant();
+
+    // Unsupported variants are ignored (and assert)
+    void forceVariant(Variant variant);
+    void clearForcedVariant();
+
+    // One kernel's builds indexed by Variant, nullptr where it has none
+    template <typename Function>
+    using Table = std::array<Function, numVariants>;
+
+    // Picks the build for the active variant, falling back to the next
+    // narrower one where the kernel doesn't have it
+    template <typename Function>
+    Function select(const Table<Function>& builds)
+    {
+        for (int variant = getActiveVariant(); variant > baseline; --variant)
+            if (builds[static_cast<size_t>(variant)] != nullptr)
+                return builds[static_cast<size_t>(variant)];
+
+        return builds[baseline];
+    }
+}
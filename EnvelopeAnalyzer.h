@@ -0,0 +1,224 @@
+// EnvelopeAnalyzer.h
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+// One analysis frame of the detector signal
+//==============================================================================
+struct AnalysisFrame
+{
+    juce::int64 position = 0;      // input sample where the frame starts
+    int onsetOffset = -1;          // onset within the frame in samples, -1 if none
+    float onsetStrength = 0.0f;    // dB over the running level at the onset, 0 if none
+    float rms = 0.0f;              // short-term RMS of the frame
+    float peak = 0.0f;             // envelope maximum of the frame
+    float crestFactor = 0.0f;      // peak / rms (sqrt 2 for a steady sine)
+    float frequency = 0.0f;        // instantaneous frequency in Hz, 0 when silent
+};
+
+//==============================================================================
+// Streaming feature extraction from the analytic signal
+//
+// Fed the Hilbert pair a = x + jH{x} that the detector computes anyway, it
+// reduces every framesPerSecond-th of a second to an AnalysisFrame in a
+// single pass:
+//
+//   rms        sqrt(mean |a|^2 / 2), ripple free even for frames shorter
+//              than the signal's period, because |a|^2 has no carrier
+//   frequency  arg(sum a[n] conj(a[n-1])) / 2pi * rate, the power weighted
+//              phase derivative, so one atan2 per frame
+//   onset      a frame more than onsetThresholdDb above the running level;
+//              the offset is the first sample over the threshold. Another
+//              one needs the level to settle back within half the threshold
+//              first (and the refractory period to pass), so a held note
+//              only triggers once
+//
+// Frames go into a wait-free single-producer / single-consumer queue like
+// ScopeFifo's: the editor drains it on its timer, offline renders drain it
+// after every block. A full queue drops frames.
+//==============================================================================
+class EnvelopeAnalyzer
+{
+public:
+    static constexpr int framesPerSecond = 200;
+    static constexpr int capacity = 2048;
+    static constexpr float onsetThresholdDb = 6.0f;
+    static constexpr float silenceDb = -70.0f;
+    static constexpr float levelTimeMs = 150.0f;
+    static constexpr float refractoryMs = 50.0f;
+
+    // prepareToPlay, while process() can't run
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        hop = juce::jmax(1, juce::roundToInt(sampleRate / framesPerSecond));
+        levelCoeff = std::exp(-1000.0f / (levelTimeMs * static_cast<float>(framesPerSecond)));
+        refractoryFrames = juce::roundToInt(refractoryMs * 0.001f * static_cast<float>(framesPerSecond));
+        position = 0;
+        reset();
+    }
+
+    // Same thread rules as prepare(): starts over from silence at the current position
+    void reset()
+    {
+        factor = 1;
+        previousReal = 0.0;
+        previousImag = 0.0;
+        runningLevelDb = silenceDb;
+        framesSinceOnset = refractoryFrames;
+        onsetArmed = true;
+        startFrame(position);
+    }
+
+    // Audio thread (or prepareToPlay): detector latency in input samples, so frame positions
+    // refer to the input rather than to the delayed analytic signal
+    void setLatency(int newLatency) { latency = newLatency; }
+
+    // Audio thread: numSamples of analytic signal at oversamplingFactor times
+    // the prepared rate
+    template <typename SampleType>
+    void process(const SampleType* real, const SampleType* imag, int numSamples, int oversamplingFactor)
+    {
+        if (oversamplingFactor != factor)
+        {
+            // The running sums don't carry over to a new rate
+            factor = oversamplingFactor;
+            previousReal = 0.0;
+            previousImag = 0.0;
+            startFrame(position);
+        }
+
+        const int frameLength = hop * factor;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double re = static_cast<double>(real[i]);
+            const double im = static_cast<double>(imag[i]);
+            const double power = re * re + im * im;
+
+            powerSum += power;
+            peakPower = juce::jmax(peakPower, power);
+
+            // a[n] conj(a[n - 1])
+            phaseReal += re * previousReal + im * previousImag;
+            phaseImag += im * previousReal - re * previousImag;
+            previousReal = re;
+            previousImag = im;
+
+            if (firstOverThreshold < 0 && power > onsetPower)
+                firstOverThreshold = frameCount;
+
+            if (++frameCount == frameLength)
+                finishFrame();
+        }
+
+        position += numSamples / factor;
+    }
+
+    // Consumer thread: hands every queued frame to callback, oldest first
+    template <typename Callback>
+    int drain(Callback&& callback)
+    {
+        const auto scope = fifo.read(fifo.getNumReady());
+
+        for (int i = 0; i < scope.blockSize1; ++i)
+            callback(frames[static_cast<size_t>(scope.startIndex1 + i)]);
+
+        for (int i = 0; i < scope.blockSize2; ++i)
+            callback(frames[static_cast<size_t>(scope.startIndex2 + i)]);
+
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+    double getSampleRate() const { return sampleRate; }
+    int getHopSize() const { return hop; }
+
+private:
+    static float toDb(double power) { return static_cast<float>(10.0 * std::log10(juce::jmax(power, 1.0e-12))); }
+
+    void startFrame(juce::int64 start)
+    {
+        frameStart = start;
+        frameCount = 0;
+        powerSum = 0.0;
+        peakPower = 0.0;
+        phaseReal = 0.0;
+        phaseImag = 0.0;
+        firstOverThreshold = -1;
+
+        // |a|^2 above this marks the onset sample, if the frame turns out to be one
+        onsetPower = std::pow(10.0, (runningLevelDb + onsetThresholdDb) / 10.0);
+    }
+
+    void finishFrame()
+    {
+        const double meanPower = powerSum / static_cast<double>(frameCount);
+        const float levelDb = toDb(meanPower);
+
+        AnalysisFrame frame;
+        frame.position = frameStart - latency;
+        frame.rms = static_cast<float>(std::sqrt(meanPower * 0.5));
+        frame.peak = static_cast<float>(std::sqrt(peakPower));
+        frame.crestFactor = frame.rms > 0.0f ? frame.peak / frame.rms : 0.0f;
+
+        if (levelDb > silenceDb)
+        {
+            const double cyclesPerSample = std::atan2(phaseImag, phaseReal) / juce::MathConstants<double>::twoPi;
+            frame.frequency = static_cast<float>(std::abs(cyclesPerSample) * sampleRate * factor);
+        }
+
+        ++framesSinceOnset;
+        const float rise = levelDb - runningLevelDb;
+
+        if (rise < onsetThresholdDb * 0.5f)
+            onsetArmed = true;
+
+        if (onsetArmed && levelDb > silenceDb && rise > onsetThresholdDb && framesSinceOnset > refractoryFrames)
+        {
+            frame.onsetOffset = juce::jmax(0, firstOverThreshold) / factor;
+            frame.onsetStrength = rise;
+            framesSinceOnset = 0;
+            onsetArmed = false;
+        }
+
+        push(frame);
+
+        runningLevelDb = levelDb + levelCoeff * (runningLevelDb - levelDb);
+        startFrame(frameStart + hop);
+    }
+
+    bool push(const AnalysisFrame& frame)
+    {
+        const auto scope = fifo.write(1);
+        if (scope.blockSize1 == 0)
+            return false;
+
+        frames[static_cast<size_t>(scope.startIndex1)] = frame;
+        return true;
+    }
+
+    juce::AbstractFifo fifo{ capacity };
+    std::array<AnalysisFrame, capacity> frames;
+
+    double sampleRate = 44100.0;
+    int hop = 220;
+    int factor = 1;
+    int latency = 0;
+    float levelCoeff = 0.0f;
+    int refractoryFrames = 10;
+
+    juce::int64 position = 0;  // input position of the current process() block
+    juce::int64 frameStart = 0;
+    int frameCount = 0;
+    double powerSum = 0.0;
+    double peakPower = 0.0;
+    double phaseReal = 0.0;
+    double phaseImag = 0.0;
+    double previousReal = 0.0;
+    double previousImag = 0.0;
+    double onsetPower = 0.0;
+    int firstOverThreshold = -1;
+    float runningLevelDb = silenceDb;
+    int framesSinceOnset = 0;
+    bool onsetArmed = true;
+};
@@ -0,0 +1,169 @@
+// EnvelopeFollower.h
+#pragma once
+#include <JuceHeader.h>
+#include "DspDispatch.h"
+
+//==============================================================================
+// Block attack/release envelope follower
+//
+// Smooths whole channel spans in place. The attack/release choice is a
+// compare-and-select rather than a branch, and groups of channels run side
+// by side in SIMD lanes, so each lane only carries its own one-pole
+// recursion. Channels left over after the last full group run as scalars.
+// The coefficients are per sample so parameter ramps stay sample accurate.
+// They are always float; the state and signal follow SampleType, and so does
+// the number of lanes (half as many for double).
+//
+// The AVX2 and AVX-512 builds (see DspDispatch.h) run 256 or 512 bits' worth
+// of channels per group as plain lane loops for the compiler to vectorise,
+// then fall back to SIMDRegister groups for what's left. prepare() picks the
+// build.
+//==============================================================================
+template <typename SampleType>
+class EnvelopeFollower
+{
+public:
+    using Lanes = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int numLanes = static_cast<int>(Lanes::SIMDNumElements);
+
+    EnvelopeFollower() = default;
+
+    void prepare(int numChannels)
+    {
+        state.assign(static_cast<size_t>(juce::jmax(1, numChannels)), static_cast<SampleType>(0));
+
+       #if HILBERT_DISPATCH_X86
+        const auto variant = DspDispatch::getActiveVariant();
+        laneKernel = DspDispatch::select<LaneKernel>({ processLanes, processLanesAvx2, processLanesAvx512 });
+        groupSize = variant == DspDispatch::avx512 ? 64 / static_cast<int>(sizeof(SampleType))
+                  : variant == DspDispatch::avx2   ? 32 / static_cast<int>(sizeof(SampleType))
+                                                   : numLanes;
+       #endif
+    }
+
+    void reset()
+    {
+        std::fill(state.begin(), state.end(), static_cast<SampleType>(0));
+    }
+
+    SampleType getState(int channel) const { return state[static_cast<size_t>(channel)]; }
+
+    // One step of the follower: attackCoeff while rising, releaseCoeff otherwise
+    static SampleType processSample(SampleType input, SampleType currentState, SampleType attackCoeff, SampleType releaseCoeff)
+    {
+        const SampleType rising = static_cast<SampleType>(input > currentState);
+        const SampleType coeff = releaseCoeff + rising * (attackCoeff - releaseCoeff);
+        return input + coeff * (currentState - input);
+    }
+
+    // Smooths channels[0..numChannels) in place, numSamples each, with
+    // attackCoeffs[i] / releaseCoeffs[i] applying to sample i of every channel.
+    // channels[n] uses follower state firstState + n
+    void process(SampleType* const* channels, int numChannels, int numSamples,
+                 const float* attackCoeffs, const float* releaseCoeffs, int firstState = 0)
+    {
+        jassert(firstState + numChannels <= static_cast<int>(state.size()));
+        SampleType* channelState = state.data() + firstState;
+
+        int channel = 0;
+        for (; channel + groupSize <= numChannels; channel += groupSize)
+            laneKernel(channels + channel, channelState + channel, numSamples, attackCoeffs, releaseCoeffs);
+
+        // Wide builds leave up to a group of channels for the narrower lanes
+        for (; channel + numLanes <= numChannels; channel += numLanes)
+            processLanes(channels + channel, channelState + channel, numSamples, attackCoeffs, releaseCoeffs);
+
+        for (; channel < numChannels; ++channel)
+        {
+            SampleType* data = channels[channel];
+            SampleType s = channelState[channel];
+
+            for (int i = 0; i < numSamples; ++i)
+                data[i] = s = processSample(data[i], s, static_cast<SampleType>(attackCoeffs[i]),
+                                            static_cast<SampleType>(releaseCoeffs[i]));
+
+            channelState[channel] = s;
+        }
+    }
+
+private:
+    using LaneKernel = void (*)(SampleType* const*, SampleType*, int, const float*, const float*);
+
+    static void processLanes(SampleType* const* channels, SampleType* laneState, int numSamples,
+                             const float* attackCoeffs, const float* releaseCoeffs)
+    {
+        alignas(Lanes::SIMDRegisterSize) SampleType values[numLanes];
+
+        std::copy_n(laneState, numLanes, values);
+        auto s = Lanes::fromRawArray(values);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int lane = 0; lane < numLanes; ++lane)
+                values[lane] = channels[lane][i];
+
+            const auto x = Lanes::fromRawArray(values);
+            const auto release = Lanes::expand(static_cast<SampleType>(releaseCoeffs[i]));
+            const auto attackMinusRelease = Lanes::expand(static_cast<SampleType>(attackCoeffs[i]) - static_cast<SampleType>(releaseCoeffs[i]));
+            const auto coeff = release + (attackMinusRelease & Lanes::greaterThan(x, s));
+            s = x + coeff * (s - x);
+
+            s.copyToRawArray(values);
+            for (int lane = 0; lane < numLanes; ++lane)
+                channels[lane][i] = values[lane];
+        }
+
+        s.copyToRawArray(values);
+        std::copy_n(values, numLanes, laneState);
+    }
+
+    // Same recursion over a fixed number of channels, as scalar lanes
+    template <int width>
+    static forcedinline void processWideLanes(SampleType* const* channels, SampleType* laneState, int numSamples,
+                                              const float* attackCoeffs, const float* releaseCoeffs)
+    {
+        alignas(64) SampleType s[width];
+        alignas(64) SampleType x[width];
+        std::copy_n(laneState, width, s);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto release = static_cast<SampleType>(releaseCoeffs[i]);
+            const auto attackMinusRelease = static_cast<SampleType>(attackCoeffs[i]) - release;
+
+            for (int lane = 0; lane < width; ++lane)
+                x[lane] = channels[lane][i];
+
+            for (int lane = 0; lane < width; ++lane)
+            {
+                const SampleType coeff = release + (x[lane] > s[lane] ? attackMinusRelease : static_cast<SampleType>(0));
+                s[lane] = x[lane] + coeff * (s[lane] - x[lane]);
+            }
+
+            for (int lane = 0; lane < width; ++lane)
+                channels[lane][i] = s[lane];
+        }
+
+        std::copy_n(s, width, laneState);
+    }
+
+   #if HILBERT_DISPATCH_X86
+    HILBERT_TARGET_AVX2 static void processLanesAvx2(SampleType* const* channels, SampleType* laneState, int numSamples,
+                                                     const float* attackCoeffs, const float* releaseCoeffs)
+    {
+        processWideLanes<32 / sizeof(SampleType)>(channels, laneState, numSamples, attackCoeffs, releaseCoeffs);
+    }
+
+    HILBERT_TARGET_AVX512 static void processLanesAvx512(SampleType* const* channels, SampleType* laneState, int numSamples,
+                                                         const float* attackCoeffs, const float* releaseCoeffs)
+    {
+        processWideLanes<64 / sizeof(SampleType)>(channels, laneState, numSamples, attackCoeffs, releaseCoeffs);
+    }
+   #endif
+
+    std::vector<SampleType> state;
+    LaneKernel laneKernel = processLanes;
+    int groupSize = numLanes;  // channels per laneKernel call
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EnvelopeFollower)
+};
@@ -1,41 +1,116 @@
 // EnvelopeScope.h
 #pragma once
 #include <JuceHeader.h>
+#include "ScopeFifo.h"
+#include "MinMaxPyramid.h"
+#include "CachedLayer.h"
 
-class EnvelopeScope : public juce::Component, private juce::Timer
+class EnvelopeScope : public juce::Component
 {
 public:
     EnvelopeScope()
+        : history(static_cast<int>(maxTimeSpanSeconds * ScopeFifo::framesPerSecond))
     {
-        startTimerHz(30);  // Lower refresh rate for CPU
-        history.resize(300, 0.0f);
-        peakHistory.resize(300, 0.0f);
+        setOpaque(true);
+    }
 
-        // Initialize with zeros
-        std::fill(history.begin(), history.end(), 0.0f);
-        std::fill(peakHistory.begin(), peakHistory.end(), 0.0f);
+    // Called for every frame drained from the processor's ScopeFifo; the
+    // editor repaints once per vblank after draining
+    void pushFrame(const ScopeFrame& frame)
+    {
+        history.push({ juce::jlimit(0.0f, 1.0f, frame.envelopeMin),
+                       juce::jlimit(0.0f, 1.0f, frame.envelopeMax),
+                       juce::jlimit(0.0f, 1.0f, frame.peak) });
     }
 
-    ~EnvelopeScope()
+    // Visible history, from one scope frame per pixel up to 60 s
+    void setTimeSpan(double seconds)
     {
-        stopTimer();
+        timeSpanSeconds = juce::jlimit(getMinTimeSpan(), maxTimeSpanSeconds, seconds);
+        repaint();
     }
 
-    void pushSample(float envelopeValue, float peakHoldValue)
+    double getTimeSpan() const { return timeSpanSeconds; }
+
+    // Any shorter and the frames would be stretched across more than one pixel each
+    double getMinTimeSpan() const
     {
-        // Add some hysteresis to prevent flickering
-        envelopeValue = juce::jlimit(0.0f, 1.0f, envelopeValue);
-        peakHoldValue = juce::jlimit(0.0f, 1.0f, peakHoldValue);
+        return juce::jmax(1, getWidth()) / static_cast<double>(ScopeFifo::framesPerSecond);
+    }
 
-        history[index] = envelopeValue;
-        peakHistory[index] = peakHoldValue;
-        index = (index + 1) % history.size();
+    void mouseWheelMove(const juce::MouseEvent&, const juce::MouseWheelDetails& wheel) override
+    {
+        setTimeSpan(timeSpanSeconds * std::pow(2.0, -wheel.deltaY * 4.0));
+    }
 
-        // Trigger repaint
-        repaint();
+    void resized() override
+    {
+        columns.resize(static_cast<size_t>(juce::jmax(1, getWidth())));
+        timeSpanSeconds = juce::jlimit(getMinTimeSpan(), maxTimeSpanSeconds, timeSpanSeconds);
+        background.invalidate();
+        overlay.invalidate();
     }
 
     void paint(juce::Graphics& g) override
+    {
+        background.draw(g, *this, [this](juce::Graphics& layer) { paintBackground(layer); });
+
+        // Draw envelope waveform: each pixel column is read from the pyramid
+        // as a min/max range, so nothing is missed at any zoom level
+        juce::Path envelopePath;
+        juce::Path peakPath;
+        const int width = static_cast<int>(columns.size());
+        const float height = static_cast<float>(getHeight());
+
+        history.read(timeSpanSeconds * ScopeFifo::framesPerSecond, columns);
+
+        for (int x = 0; x < width; ++x)
+        {
+            const auto& column = columns[static_cast<size_t>(x)];
+
+            // Convert amplitude to Y coordinate (0 at top, 1 at bottom)
+            const float maxY = height * (1.0f - column.envelopeMax);
+            const float peakY = height * (1.0f - column.peak);
+
+            if (x == 0)
+            {
+                envelopePath.startNewSubPath(static_cast<float>(x), maxY);
+                peakPath.startNewSubPath(static_cast<float>(x), peakY);
+            }
+            else
+            {
+                envelopePath.lineTo(static_cast<float>(x), maxY);
+                peakPath.lineTo(static_cast<float>(x), peakY);
+            }
+        }
+
+        // Close the range back along the minima
+        for (int x = width - 1; x >= 0; --x)
+            envelopePath.lineTo(static_cast<float>(x), height * (1.0f - columns[static_cast<size_t>(x)].envelopeMin));
+        envelopePath.closeSubPath();
+
+        // Draw envelope range (cyan)
+        g.setColour(juce::Colour(100, 200, 255).withAlpha(0.6f));
+        g.fillPath(envelopePath);
+        g.setColour(juce::Colour(100, 200, 255));
+        g.strokePath(envelopePath, juce::PathStrokeType(1.0f));
+
+        // Draw peak path (red)
+        g.setColour(juce::Colour(255, 100, 100).withAlpha(0.7f));
+        g.strokePath(peakPath, juce::PathStrokeType(1.0f));
+
+        overlay.draw(g, *this, [this](juce::Graphics& layer) { paintOverlay(layer); });
+
+        // Visible time span
+        g.setColour(juce::Colour(150, 150, 150));
+        const juce::String span = timeSpanSeconds < 1.0 ? juce::String(timeSpanSeconds * 1000.0, 0) + " ms"
+                                                        : juce::String(timeSpanSeconds, 1) + " s";
+        g.drawText(span, getWidth() - 80, getHeight() - 20, 75, 15, juce::Justification::right);
+    }
+
+private:
+    // Static layers, re-rendered only when the size or display scale changes
+    void paintBackground(juce::Graphics& g)
     {
         // Dark background
         g.fillAll(juce::Colour(20, 22, 25));
@@ -69,45 +144,11 @@ public:
         float db6Line = getHeight() * 0.5f;  // 0.5 amplitude = -6dB
         g.setColour(juce::Colour(60, 60, 60).withAlpha(0.2f));
         g.drawHorizontalLine(static_cast<int>(db6Line), 0, getWidth());
+    }
 
-        // Draw envelope waveform
-        juce::Path envelopePath;
-        juce::Path peakPath;
-        bool envelopeStarted = false;
-        bool peakStarted = false;
-
-        for (size_t i = 0; i < history.size(); ++i)
-        {
-            size_t idx = (index + i) % history.size();
-            float x = static_cast<float>(i) / history.size() * getWidth();
-
-            // Convert amplitude to Y coordinate (0 at top, 1 at bottom)
-            float envY = getHeight() * (1.0f - history[idx]);
-            float peakY = getHeight() * (1.0f - peakHistory[idx]);
-
-            // Clamp to bounds
-            envY = juce::jlimit(0.0f, static_cast<float>(getHeight()), envY);
-            peakY = juce::jlimit(0.0f, static_cast<float>(getHeight()), peakY);
-
-            if (i == 0)
-            {
-                envelopePath.startNewSubPath(x, envY);
-                peakPath.startNewSubPath(x, peakY);
-            }
-            else
-            {
-                envelopePath.lineTo(x, envY);
-                peakPath.lineTo(x, peakY);
-            }
-        }
-
-        // Draw envelope path (cyan)
-        g.setColour(juce::Colour(100, 200, 255));
-        g.strokePath(envelopePath, juce::PathStrokeType(2.0f));
-
-        // Draw peak path (red)
-        g.setColour(juce::Colour(255, 100, 100).withAlpha(0.7f));
-        g.strokePath(peakPath, juce::PathStrokeType(1.0f));
+    void paintOverlay(juce::Graphics& g)
+    {
+        const float db6Line = getHeight() * 0.5f;
 
         // Draw labels
         g.setColour(juce::Colour(180, 180, 180));
@@ -126,13 +167,12 @@ public:
         g.drawText("Peak Hold", getWidth() - 80, 25, 75, 15, juce::Justification::right);
     }
 
-private:
-    void timerCallback() override
-    {
-        repaint();
-    }
+    static constexpr double maxTimeSpanSeconds = 60.0;
+
+    MinMaxPyramid history;
+    std::vector<ScopeFrame> columns = std::vector<ScopeFrame>(1);
+    double timeSpanSeconds = 10.0;
 
-    std::vector<float> history;
-    std::vector<float> peakHistory;
-    size_t index = 0;
+    CachedLayer background;
+    CachedLayer overlay;
 };
\ No newline at end of file
@@ -0,0 +1,405 @@
+// FixedHilbertFir.h
+#pragma once
+#include <JuceHeader.h>
+#include "HilbertBackend.h"
+#include "HilbertKernelDesign.h"
+#include "DspDispatch.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#elif JUCE_ARM && JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+//==============================================================================
+// Hilbert FIR kernels with a compile-time tap count
+//
+// The coefficients are the windowed ideal Hilbert transformer of
+// HilbertKernelDesign.h, generated by constexpr code. They are
+// antisymmetric about the centre, so each sample costs one multiply per
+// pair of taps:
+//
+//     y[t] = sum_j gains[j] * (x[t - centre - k_j] - x[t - centre + k_j])
+//
+// The pair sum is expanded with a fold expression, so every instantiation
+// is fully unrolled with its gains as immediate constants. The real branch
+// is the input delayed by the centre tap, which is also the latency.
+//
+// The chunk loop is written out with intrinsics for each instruction set
+// (SSE2 or NEON as the baseline, AVX2 + FMA and AVX-512 on x86; see
+// DspDispatch.h) and prepare() picks the one for this CPU. processReference()
+// is the plain scalar loop the builds are checked against.
+//==============================================================================
+namespace HilbertKernelDesign
+{
+    // Choices for the "quality" parameter, cheapest first
+    constexpr std::array<int, 4> tapCounts{ 15, 31, 63, 127 };
+
+    // Every kernel the Standard engine builds: the quality choices, then the
+    // longer ones an oversampled detector steps up to
+    constexpr std::array<int, 7> kernelTapCounts{ 15, 31, 63, 127, 255, 511, 1023 };
+
+    inline const juce::StringArray& getQualityNames()
+    {
+        static const juce::StringArray names{ "15 Taps", "31 Taps", "63 Taps", "127 Taps" };
+        return names;
+    }
+}
+
+template <int NumTaps>
+class FixedHilbertFir : public HilbertBackend
+{
+public:
+    static_assert(NumTaps % 2 == 1, "Hilbert kernels need an odd length with a centre tap");
+
+    static constexpr int numTaps = NumTaps;
+    static constexpr int centre = NumTaps / 2;
+    static constexpr int numPairs = (centre + 1) / 2;  // odd offsets 1, 3, ... <= centre
+
+    // Clang caps a fold expression at 256 operands (its bracket depth)
+    static_assert(numPairs <= 256, "Longer kernels need the pair sum split over several folds");
+
+    static constexpr auto pairs = HilbertKernelDesign::designPairs<NumTaps>();
+
+    void prepare(int numChannels, int maxBlockSize) override
+    {
+        juce::ignoreUnused(maxBlockSize);
+        lines.setSize(juce::jmax(1, numChannels), historySize + chunkSize);
+        doubleLines.setSize(juce::jmax(1, numChannels), historySize + chunkSize);
+
+       #if HILBERT_DISPATCH_X86
+        floatKernel = DspDispatch::select<ChunkKernel<float>>({ filterChunk<float>, filterChunkAvx2<float>, filterChunkAvx512<float> });
+        doubleKernel = DspDispatch::select<ChunkKernel<double>>({ filterChunk<double>, filterChunkAvx2<double>, filterChunkAvx512<double> });
+       #endif
+        reset();
+    }
+
+    void reset() override
+    {
+        lines.clear();
+        doubleLines.clear();
+    }
+
+    int getLatencySamples() const override { return centre; }
+
+    void process(int channel, const float* input, float* real, float* imag, int numSamples) override
+    {
+        processChannel(lines, floatKernel, channel, input, real, imag, numSamples);
+    }
+
+    void process(int channel, const double* input, double* real, double* imag, int numSamples) override
+    {
+        processChannel(doubleLines, doubleKernel, channel, input, real, imag, numSamples);
+    }
+
+    // Scalar reference path, sharing the same state as process(): a plain
+    // loop over the tap pairs and the centre delay. The two agree to within
+    // rounding of the summation order.
+    void processReference(int channel, const float* input, float* real, float* imag, int numSamples)
+    {
+        processChannel(lines, referenceChunk<float>, channel, input, real, imag, numSamples);
+    }
+
+    void processReference(int channel, const double* input, double* real, double* imag, int numSamples)
+    {
+        processChannel(doubleLines, referenceChunk<double>, channel, input, real, imag, numSamples);
+    }
+
+private:
+    static constexpr int historySize = NumTaps - 1;
+    static constexpr int chunkSize = 256;
+
+    template <typename SampleType>
+    using ChunkKernel = void (*)(const SampleType* centreSamples, SampleType* real, SampleType* imag, int numSamples);
+
+    template <typename SampleType, size_t... J>
+    static forcedinline SampleType sumPairs(const SampleType* centreSample, std::index_sequence<J...>)
+    {
+        return ((static_cast<SampleType>(pairs[J].gain)
+                 * (centreSample[-pairs[J].offset] - centreSample[pairs[J].offset])) + ...);
+    }
+
+    template <typename SampleType>
+    static forcedinline void sumPairsFrom(const SampleType* centreSamples, SampleType* imag, int start, int numSamples)
+    {
+        for (int i = start; i < numSamples; ++i)
+            imag[i] = sumPairs(centreSamples + i, std::make_index_sequence<numPairs>());
+    }
+
+    // Output sample i is centred on centreSamples[i]. The vector loops below
+    // compute four registers of outputs per pass, each with its own
+    // accumulator, then one register at a time, then the scalar leftovers.
+    template <typename SampleType>
+    static void filterChunk(const SampleType* centreSamples, SampleType* real, SampleType* imag, int numSamples)
+    {
+        std::memcpy(real, centreSamples, sizeof(SampleType) * static_cast<size_t>(numSamples));
+
+       #if JUCE_INTEL
+        sse2Loop(centreSamples, imag, numSamples, std::make_index_sequence<numPairs>());
+       #elif JUCE_ARM && JUCE_USE_ARM_NEON
+        if constexpr (std::is_same_v<SampleType, float> || JUCE_64BIT)
+            neonLoop(centreSamples, imag, numSamples, std::make_index_sequence<numPairs>());
+        else
+            sumPairsFrom(centreSamples, imag, 0, numSamples);
+       #else
+        sumPairsFrom(centreSamples, imag, 0, numSamples);
+       #endif
+    }
+
+    template <typename SampleType>
+    static void referenceChunk(const SampleType* centreSamples, SampleType* real, SampleType* imag, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            SampleType sum = 0;
+            for (const auto& pair : pairs)
+                sum += static_cast<SampleType>(pair.gain) * (centreSamples[i - pair.offset] - centreSamples[i + pair.offset]);
+
+            real[i] = centreSamples[i];
+            imag[i] = sum;
+        }
+    }
+
+   #if JUCE_INTEL
+    //==============================================================================
+    // SSE2, the x86 baseline
+    static forcedinline __m128 sse2Zero(float) { return _mm_setzero_ps(); }
+    static forcedinline __m128d sse2Zero(double) { return _mm_setzero_pd(); }
+
+    static forcedinline __m128 sse2Term(__m128 sum, const float* centre, double gain, int offset)
+    {
+        const auto difference = _mm_sub_ps(_mm_loadu_ps(centre - offset), _mm_loadu_ps(centre + offset));
+        return _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(static_cast<float>(gain)), difference));
+    }
+
+    static forcedinline __m128d sse2Term(__m128d sum, const double* centre, double gain, int offset)
+    {
+        const auto difference = _mm_sub_pd(_mm_loadu_pd(centre - offset), _mm_loadu_pd(centre + offset));
+        return _mm_add_pd(sum, _mm_mul_pd(_mm_set1_pd(gain), difference));
+    }
+
+    static forcedinline void sse2Store(float* destination, __m128 value) { _mm_storeu_ps(destination, value); }
+    static forcedinline void sse2Store(double* destination, __m128d value) { _mm_storeu_pd(destination, value); }
+
+    template <typename SampleType, size_t... J>
+    static forcedinline void sse2Loop(const SampleType* c, SampleType* imag, int numSamples, std::index_sequence<J...>)
+    {
+        constexpr int width = 16 / static_cast<int>(sizeof(SampleType));
+        int i = 0;
+
+        for (; i + 4 * width <= numSamples; i += 4 * width)
+        {
+            auto s0 = sse2Zero(SampleType()), s1 = s0, s2 = s0, s3 = s0;
+            ((s0 = sse2Term(s0, c + i, pairs[J].gain, pairs[J].offset),
+              s1 = sse2Term(s1, c + i + width, pairs[J].gain, pairs[J].offset),
+              s2 = sse2Term(s2, c + i + 2 * width, pairs[J].gain, pairs[J].offset),
+              s3 = sse2Term(s3, c + i + 3 * width, pairs[J].gain, pairs[J].offset)), ...);
+            sse2Store(imag + i, s0);
+            sse2Store(imag + i + width, s1);
+            sse2Store(imag + i + 2 * width, s2);
+            sse2Store(imag + i + 3 * width, s3);
+        }
+
+        for (; i + width <= numSamples; i += width)
+        {
+            auto sum = sse2Zero(SampleType());
+            ((sum = sse2Term(sum, c + i, pairs[J].gain, pairs[J].offset)), ...);
+            sse2Store(imag + i, sum);
+        }
+
+        sumPairsFrom(c, imag, i, numSamples);
+    }
+   #endif
+
+   #if HILBERT_DISPATCH_X86
+    //==============================================================================
+    // AVX2 + FMA
+    HILBERT_TARGET_AVX2 static forcedinline __m256 avx2Zero(float) { return _mm256_setzero_ps(); }
+    HILBERT_TARGET_AVX2 static forcedinline __m256d avx2Zero(double) { return _mm256_setzero_pd(); }
+
+    HILBERT_TARGET_AVX2 static forcedinline __m256 avx2Term(__m256 sum, const float* centre, double gain, int offset)
+    {
+        const auto difference = _mm256_sub_ps(_mm256_loadu_ps(centre - offset), _mm256_loadu_ps(centre + offset));
+        return _mm256_fmadd_ps(_mm256_set1_ps(static_cast<float>(gain)), difference, sum);
+    }
+
+    HILBERT_TARGET_AVX2 static forcedinline __m256d avx2Term(__m256d sum, const double* centre, double gain, int offset)
+    {
+        const auto difference = _mm256_sub_pd(_mm256_loadu_pd(centre - offset), _mm256_loadu_pd(centre + offset));
+        return _mm256_fmadd_pd(_mm256_set1_pd(gain), difference, sum);
+    }
+
+    HILBERT_TARGET_AVX2 static forcedinline void avx2Store(float* destination, __m256 value) { _mm256_storeu_ps(destination, value); }
+    HILBERT_TARGET_AVX2 static forcedinline void avx2Store(double* destination, __m256d value) { _mm256_storeu_pd(destination, value); }
+
+    template <typename SampleType, size_t... J>
+    HILBERT_TARGET_AVX2 static forcedinline void avx2Loop(const SampleType* c, SampleType* imag, int numSamples, std::index_sequence<J...>)
+    {
+        constexpr int width = 32 / static_cast<int>(sizeof(SampleType));
+        int i = 0;
+
+        for (; i + 4 * width <= numSamples; i += 4 * width)
+        {
+            auto s0 = avx2Zero(SampleType()), s1 = s0, s2 = s0, s3 = s0;
+            ((s0 = avx2Term(s0, c + i, pairs[J].gain, pairs[J].offset),
+              s1 = avx2Term(s1, c + i + width, pairs[J].gain, pairs[J].offset),
+              s2 = avx2Term(s2, c + i + 2 * width, pairs[J].gain, pairs[J].offset),
+              s3 = avx2Term(s3, c + i + 3 * width, pairs[J].gain, pairs[J].offset)), ...);
+            avx2Store(imag + i, s0);
+            avx2Store(imag + i + width, s1);
+            avx2Store(imag + i + 2 * width, s2);
+            avx2Store(imag + i + 3 * width, s3);
+        }
+
+        for (; i + width <= numSamples; i += width)
+        {
+            auto sum = avx2Zero(SampleType());
+            ((sum = avx2Term(sum, c + i, pairs[J].gain, pairs[J].offset)), ...);
+            avx2Store(imag + i, sum);
+        }
+
+        sumPairsFrom(c, imag, i, numSamples);
+    }
+
+    template <typename SampleType>
+    HILBERT_TARGET_AVX2 static void filterChunkAvx2(const SampleType* centreSamples, SampleType* real, SampleType* imag, int numSamples)
+    {
+        std::memcpy(real, centreSamples, sizeof(SampleType) * static_cast<size_t>(numSamples));
+        avx2Loop(centreSamples, imag, numSamples, std::make_index_sequence<numPairs>());
+    }
+
+    //==============================================================================
+    // AVX-512F
+    HILBERT_TARGET_AVX512 static forcedinline __m512 avx512Zero(float) { return _mm512_setzero_ps(); }
+    HILBERT_TARGET_AVX512 static forcedinline __m512d avx512Zero(double) { return _mm512_setzero_pd(); }
+
+    HILBERT_TARGET_AVX512 static forcedinline __m512 avx512Term(__m512 sum, const float* centre, double gain, int offset)
+    {
+        const auto difference = _mm512_sub_ps(_mm512_loadu_ps(centre - offset), _mm512_loadu_ps(centre + offset));
+        return _mm512_fmadd_ps(_mm512_set1_ps(static_cast<float>(gain)), difference, sum);
+    }
+
+    HILBERT_TARGET_AVX512 static forcedinline __m512d avx512Term(__m512d sum, const double* centre, double gain, int offset)
+    {
+        const auto difference = _mm512_sub_pd(_mm512_loadu_pd(centre - offset), _mm512_loadu_pd(centre + offset));
+        return _mm512_fmadd_pd(_mm512_set1_pd(gain), difference, sum);
+    }
+
+    HILBERT_TARGET_AVX512 static forcedinline void avx512Store(float* destination, __m512 value) { _mm512_storeu_ps(destination, value); }
+    HILBERT_TARGET_AVX512 static forcedinline void avx512Store(double* destination, __m512d value) { _mm512_storeu_pd(destination, value); }
+
+    template <typename SampleType, size_t... J>
+    HILBERT_TARGET_AVX512 static forcedinline void avx512Loop(const SampleType* c, SampleType* imag, int numSamples, std::index_sequence<J...>)
+    {
+        constexpr int width = 64 / static_cast<int>(sizeof(SampleType));
+        int i = 0;
+
+        for (; i + 4 * width <= numSamples; i += 4 * width)
+        {
+            auto s0 = avx512Zero(SampleType()), s1 = s0, s2 = s0, s3 = s0;
+            ((s0 = avx512Term(s0, c + i, pairs[J].gain, pairs[J].offset),
+              s1 = avx512Term(s1, c + i + width, pairs[J].gain, pairs[J].offset),
+              s2 = avx512Term(s2, c + i + 2 * width, pairs[J].gain, pairs[J].offset),
+              s3 = avx512Term(s3, c + i + 3 * width, pairs[J].gain, pairs[J].offset)), ...);
+            avx512Store(imag + i, s0);
+            avx512Store(imag + i + width, s1);
+            avx512Store(imag + i + 2 * width, s2);
+            avx512Store(imag + i + 3 * width, s3);
+        }
+
+        for (; i + width <= numSamples; i += width)
+        {
+            auto sum = avx512Zero(SampleType());
+            ((sum = avx512Term(sum, c + i, pairs[J].gain, pairs[J].offset)), ...);
+            avx512Store(imag + i, sum);
+        }
+
+        sumPairsFrom(c, imag, i, numSamples);
+    }
+
+    template <typename SampleType>
+    HILBERT_TARGET_AVX512 static void filterChunkAvx512(const SampleType* centreSamples, SampleType* real, SampleType* imag, int numSamples)
+    {
+        std::memcpy(real, centreSamples, sizeof(SampleType) * static_cast<size_t>(numSamples));
+        avx512Loop(centreSamples, imag, numSamples, std::make_index_sequence<numPairs>());
+    }
+   #endif
+
+   #if JUCE_ARM && JUCE_USE_ARM_NEON
+    //==============================================================================
+    // NEON, the ARM baseline (double lanes on AArch64 only)
+    static forcedinline float32x4_t neonZero(float) { return vdupq_n_f32(0.0f); }
+
+    static forcedinline float32x4_t neonTerm(float32x4_t sum, const float* centre, double gain, int offset)
+    {
+        const auto difference = vsubq_f32(vld1q_f32(centre - offset), vld1q_f32(centre + offset));
+        return vmlaq_n_f32(sum, difference, static_cast<float>(gain));
+    }
+
+    static forcedinline void neonStore(float* destination, float32x4_t value) { vst1q_f32(destination, value); }
+
+    #if JUCE_64BIT
+    static forcedinline float64x2_t neonZero(double) { return vdupq_n_f64(0.0); }
+
+    static forcedinline float64x2_t neonTerm(float64x2_t sum, const double* centre, double gain, int offset)
+    {
+        const auto difference = vsubq_f64(vld1q_f64(centre - offset), vld1q_f64(centre + offset));
+        return vfmaq_n_f64(sum, difference, gain);
+    }
+
+    static forcedinline void neonStore(double* destination, float64x2_t value) { vst1q_f64(destination, value); }
+    #endif
+
+    template <typename SampleType, size_t... J>
+    static forcedinline void neonLoop(const SampleType* c, SampleType* imag, int numSamples, std::index_sequence<J...>)
+    {
+        constexpr int width = 16 / static_cast<int>(sizeof(SampleType));
+        int i = 0;
+
+        for (; i + 4 * width <= numSamples; i += 4 * width)
+        {
+            auto s0 = neonZero(SampleType()), s1 = s0, s2 = s0, s3 = s0;
+            ((s0 = neonTerm(s0, c + i, pairs[J].gain, pairs[J].offset),
+              s1 = neonTerm(s1, c + i + width, pairs[J].gain, pairs[J].offset),
+              s2 = neonTerm(s2, c + i + 2 * width, pairs[J].gain, pairs[J].offset),
+              s3 = neonTerm(s3, c + i + 3 * width, pairs[J].gain, pairs[J].offset)), ...);
+            neonStore(imag + i, s0);
+            neonStore(imag + i + width, s1);
+            neonStore(imag + i + 2 * width, s2);
+            neonStore(imag + i + 3 * width, s3);
+        }
+
+        for (; i + width <= numSamples; i += width)
+        {
+            auto sum = neonZero(SampleType());
+            ((sum = neonTerm(sum, c + i, pairs[J].gain, pairs[J].offset)), ...);
+            neonStore(imag + i, sum);
+        }
+
+        sumPairsFrom(c, imag, i, numSamples);
+    }
+   #endif
+
+    // Each channel's line holds the last historySize samples followed by the
+    // current chunk, so every tap is a plain offset from the output sample
+    template <typename SampleType>
+    static void processChannel(juce::AudioBuffer<SampleType>& channelLines, ChunkKernel<SampleType> kernel, int channel,
+        const SampleType* input, SampleType* real, SampleType* imag, int numSamples)
+    {
+        jassert(juce::isPositiveAndBelow(channel, channelLines.getNumChannels()));
+        SampleType* line = channelLines.getWritePointer(channel);
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            const int n = juce::jmin(chunkSize, numSamples - start);
+            std::memcpy(line + historySize, input + start, sizeof(SampleType) * static_cast<size_t>(n));
+            kernel(line + historySize - centre, real + start, imag + start, n);
+            std::memmove(line, line + n, sizeof(SampleType) * static_cast<size_t>(historySize));
+        }
+    }
+
+    juce::AudioBuffer<float> lines;  // one delay line per channel
+    juce::AudioBuffer<double> doubleLines;
+    ChunkKernel<float> floatKernel = filterChunk<float>;
+    ChunkKernel<double> doubleKernel = filterChunk<double>;
+};
@@ -0,0 +1,27 @@
+// HilbertBackend.h
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+// Common interface for the Hilbert engines
+//
+// A backend turns one channel of input into an analytic pair (real, imag)
+// whose magnitude is the envelope. Each backend keeps its own per-channel
+// state; the processor delays the dry signal by getLatencySamples() so it
+// lines up with the pair. Every backend takes float and double blocks, and
+// prepare() allocates for both.
+//==============================================================================
+class HilbertBackend
+{
+public:
+    virtual ~HilbertBackend() = default;
+
+    // Allocates all per-channel state. Called from prepareToPlay only.
+    virtual void prepare(int numChannels, int maxBlockSize) = 0;
+    virtual void reset() = 0;
+
+    virtual int getLatencySamples() const = 0;
+
+    virtual void process(int channel, const float* input, float* real, float* imag, int numSamples) = 0;
+    virtual void process(int channel, const double* input, double* real, double* imag, int numSamples) = 0;
+};
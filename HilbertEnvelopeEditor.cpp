@@ -227,10 +227,49 @@ void EnvelopeMeterWithBlock::setBlockValue(float value)
 //==============================================================================
 VerticalEnvelopeMeter::VerticalEnvelopeMeter()
 {
+    setOpaque(true);
     setSize(60, 200);
 }
 
 void VerticalEnvelopeMeter::paint(juce::Graphics& g)
+{
+    // Background, scale and labels (cached)
+    background.draw(g, *this, [this](juce::Graphics& layer) { paintBackground(layer); });
+
+    const float meterHeight = getMeterY(value);
+
+    // Gradient fill for meter (green at bottom, red at top)
+    juce::ColourGradient meterGrad(
+        juce::Colour(100, 255, 100), 0, getHeight(),  // Green at bottom (silence)
+        juce::Colour(255, 100, 100), 0, 0,            // Red at top (clipping)
+        false);
+
+    // Fill the portion from meterHeight to bottom
+    g.setGradientFill(meterGrad);
+
+    // FIXED LINE 265: Use all float arguments
+    g.fillRect(25.0f, meterHeight, static_cast<float>(getWidth() - 40), getHeight() - meterHeight);
+
+    // Draw current value line
+    g.setColour(juce::Colours::white.withAlpha(0.8f));
+    g.drawHorizontalLine(static_cast<int>(meterHeight), 25, getWidth() - 15);
+
+    // Draw current value indicator (already uses integers - OK)
+    g.setColour(juce::Colours::white);
+    g.fillRect(getWidth() - 15, static_cast<int>(meterHeight) - 1, 10, 3);
+
+    // Draw value text
+    g.setColour(juce::Colour(200, 200, 200));
+    g.setFont(juce::FontOptions(11.0f, juce::Font::bold));
+    g.drawText(valueText, getTextArea(), juce::Justification::centred);
+}
+
+void VerticalEnvelopeMeter::resized()
+{
+    background.invalidate();
+}
+
+void VerticalEnvelopeMeter::paintBackground(juce::Graphics& g)
 {
     // Background
     g.fillAll(juce::Colour(25, 27, 30));
@@ -253,65 +292,64 @@ void VerticalEnvelopeMeter::paint(juce::Graphics& g)
     g.drawText("-20", 5, getHeight() * 0.5f - 7, 20, 15, juce::Justification::centred);
     g.drawText("-40", 5, getHeight() * 0.75f - 7, 20, 15, juce::Justification::centred);
     g.drawText("-∞", 5, getHeight() - 15, 20, 15, juce::Justification::centred);
+}
 
+float VerticalEnvelopeMeter::getMeterY(float level) const
+{
     // Draw meter value - convert linear to logarithmic for visual
     float logValue = 0.0f;
-    if (value > 0.0001f)
+    if (level > 0.0001f)
     {
         // Convert to dB scale for display: 0dB at top, -∞ at bottom
-        logValue = 1.0f - (std::log10(value * 9.0f + 1.0f) / std::log10(10.0f));
+        logValue = 1.0f - (std::log10(level * 9.0f + 1.0f) / std::log10(10.0f));
     }
     else
     {
         logValue = 1.0f; // All the way at bottom for silence
     }
 
-    float meterHeight = getHeight() * logValue;
-    meterHeight = juce::jlimit(0.0f, static_cast<float>(getHeight()), meterHeight);
-
-    // Gradient fill for meter (green at bottom, red at top)
-    juce::ColourGradient meterGrad(
-        juce::Colour(100, 255, 100), 0, getHeight(),  // Green at bottom (silence)
-        juce::Colour(255, 100, 100), 0, 0,            // Red at top (clipping)
-        false);
+    return juce::jlimit(0.0f, static_cast<float>(getHeight()), getHeight() * logValue);
+}
 
-    // Fill the portion from meterHeight to bottom
-    g.setGradientFill(meterGrad);
+juce::Rectangle<int> VerticalEnvelopeMeter::getTextArea() const
+{
+    return { 0, getHeight() - 25, getWidth(), 20 };
+}
 
-    // FIXED LINE 265: Use all float arguments
-    g.fillRect(25.0f, meterHeight, static_cast<float>(getWidth() - 40), getHeight() - meterHeight);
+void VerticalEnvelopeMeter::setValue(float newValue)
+{
+    newValue = juce::jlimit(0.0f, 1.0f, newValue);
 
-    // Draw current value line
-    g.setColour(juce::Colours::white.withAlpha(0.8f));
-    g.drawHorizontalLine(static_cast<int>(meterHeight), 25, getWidth() - 15);
+    juce::String newText;
+    if (newValue < 0.001f)
+        newText = "-∞ dB";
+    else
+        newText = juce::String(20.0f * std::log10(newValue), 1) + " dB";
 
-    // Draw current value indicator (already uses integers - OK)
-    g.setColour(juce::Colours::white);
-    g.fillRect(getWidth() - 15, static_cast<int>(meterHeight) - 1, 10, 3);
+    const int oldY = static_cast<int>(getMeterY(value));
+    const int newY = static_cast<int>(getMeterY(newValue));
+    value = newValue;
 
-    // Draw value text
-    g.setColour(juce::Colour(200, 200, 200));
-    g.setFont(juce::FontOptions(11.0f, juce::Font::bold));
-    juce::String valueStr;
-    if (value < 0.001f)
-        valueStr = "-∞ dB";
-    else
-        valueStr = juce::String(20.0f * std::log10(value), 1) + " dB";
-    g.drawText(valueStr, 0, getHeight() - 25, getWidth(), 20, juce::Justification::centred);
-}
+    // Repaint only the band the meter top moved through, plus the text if it changed
+    if (oldY != newY)
+        repaint(0, juce::jmin(oldY, newY) - 2, getWidth(), std::abs(newY - oldY) + 5);
 
-void VerticalEnvelopeMeter::setValue(float newValue)
-{
-    value = juce::jlimit(0.0f, 1.0f, newValue);
-    repaint();
+    if (newText != valueText)
+    {
+        valueText = newText;
+        repaint(getTextArea());
+    }
 }
 
 //==============================================================================
 // Main Editor Implementation
 //==============================================================================
 HilbertEnvelopeEditor::HilbertEnvelopeEditor(HilbertEnvelopeProcessor& p)
-    : AudioProcessorEditor(&p), processor(p)
+    : AudioProcessorEditor(&p), processor(p),
+    vblankAttachment(this, [this] { updateDisplays(); })
 {
+    setOpaque(true);
+
     setSize(1000, 700);  // Increased size for scope
     setResizable(true, true);
     setResizeLimits(800, 550, 1400, 900);
@@ -354,6 +392,20 @@ HilbertEnvelopeEditor::HilbertEnvelopeEditor(HilbertEnvelopeProcessor& p)
 
     addAndMakeVisible(envelopeScope);
 
+    // Latest analysis frame and a running onset count
+    analysisLabel.setFont(juce::FontOptions(juce::Font::getDefaultMonospacedFontName(), 10.0f, juce::Font::plain));
+    analysisLabel.setColour(juce::Label::textColourId, juce::Colour(180, 180, 180));
+    analysisLabel.setJustificationType(juce::Justification::centredLeft);
+    addAndMakeVisible(analysisLabel);
+
+    // Per-stage CPU timings, only when the profiler is compiled in
+    profileLabel.setFont(juce::FontOptions(juce::Font::getDefaultMonospacedFontName(), 10.0f, juce::Font::plain));
+    profileLabel.setColour(juce::Label::textColourId, juce::Colour(150, 200, 150));
+    profileLabel.setJustificationType(juce::Justification::topLeft);
+    profileLabel.setText("Waiting for audio...", juce::dontSendNotification);
+    if (StageProfiler::isEnabled)
+        addAndMakeVisible(profileLabel);
+
     // Setup mode selector
     modeLabel.setText("PROCESSING MODE:", juce::dontSendNotification);
     modeLabel.setFont(juce::FontOptions(12.0f, juce::Font::bold));
@@ -368,10 +420,7 @@ HilbertEnvelopeEditor::HilbertEnvelopeEditor(HilbertEnvelopeProcessor& p)
     modeSelector.setSelectedId(1, juce::dontSendNotification);
 
     // Style the combobox
-    modeSelector.setColour(juce::ComboBox::backgroundColourId, juce::Colour(40, 40, 45));
-    modeSelector.setColour(juce::ComboBox::textColourId, juce::Colour(220, 220, 220));
-    modeSelector.setColour(juce::ComboBox::arrowColourId, juce::Colour(180, 180, 180));
-    modeSelector.setColour(juce::ComboBox::outlineColourId, juce::Colour(80, 80, 85));
+    styleComboBox(modeSelector);
 
     // Attach to parameter
     modeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
@@ -379,6 +428,46 @@ HilbertEnvelopeEditor::HilbertEnvelopeEditor(HilbertEnvelopeProcessor& p)
 
     addAndMakeVisible(modeSelector);
 
+    // Setup channel link selector
+    linkSelector.addItem("Unlinked", 1);
+    linkSelector.addItem("Link Max", 2);
+    linkSelector.addItem("Link RMS", 3);
+    linkSelector.addItem("Link Mid", 4);
+    styleComboBox(linkSelector);
+    linkAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        apvts, "link", linkSelector);
+    addAndMakeVisible(linkSelector);
+
+    // Setup Hilbert engine selector
+    engineLabel.setText("ENGINE:", juce::dontSendNotification);
+    engineLabel.setFont(juce::FontOptions(12.0f, juce::Font::bold));
+    engineLabel.setColour(juce::Label::textColourId, juce::Colour(200, 200, 200));
+    engineLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(engineLabel);
+
+    engineSelector.addItem("Standard FIR", 1);
+    engineSelector.addItem("High Precision (FFT)", 2);
+    engineSelector.addItem("Low Latency (IIR)", 3);
+    styleComboBox(engineSelector);
+    engineAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        apvts, "engine", engineSelector);
+    addAndMakeVisible(engineSelector);
+
+    const auto& lengthNames = HilbertFftConvolver::getKernelLengthNames();
+    for (int i = 0; i < lengthNames.size(); ++i)
+        precisionSelector.addItem(lengthNames[i] + " taps", i + 1);
+    styleComboBox(precisionSelector);
+    precisionAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        apvts, "precision", precisionSelector);
+    addAndMakeVisible(precisionSelector);
+
+    // Tap count of the Standard engine's FIR
+    qualitySelector.addItemList(HilbertKernelDesign::getQualityNames(), 1);
+    styleComboBox(qualitySelector);
+    qualityAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        apvts, "quality", qualitySelector);
+    addAndMakeVisible(qualitySelector);
+
     // Setup labels
     titleLabel.setText("HILBERT ENVELOPE DETECTOR", juce::dontSendNotification);
     titleLabel.setFont(juce::FontOptions(26.0f, juce::Font::bold));
@@ -397,15 +486,25 @@ HilbertEnvelopeEditor::HilbertEnvelopeEditor(HilbertEnvelopeProcessor& p)
     statusLabel.setColour(juce::Label::textColourId, juce::Colour(150, 200, 150));
     statusLabel.setJustificationType(juce::Justification::centred);
     addAndMakeVisible(statusLabel);
-
-    // Start timer for updates
-    startTimerHz(30);
 }
 
 HilbertEnvelopeEditor::~HilbertEnvelopeEditor() {}
 
+void HilbertEnvelopeEditor::styleComboBox(juce::ComboBox& box)
+{
+    box.setColour(juce::ComboBox::backgroundColourId, juce::Colour(40, 40, 45));
+    box.setColour(juce::ComboBox::textColourId, juce::Colour(220, 220, 220));
+    box.setColour(juce::ComboBox::arrowColourId, juce::Colour(180, 180, 180));
+    box.setColour(juce::ComboBox::outlineColourId, juce::Colour(80, 80, 85));
+}
+
 //==============================================================================
 void HilbertEnvelopeEditor::paint(juce::Graphics& g)
+{
+    background.draw(g, *this, [this](juce::Graphics& layer) { paintBackground(layer); });
+}
+
+void HilbertEnvelopeEditor::paintBackground(juce::Graphics& g)
 {
     // Dark metal background with subtle gradient
     juce::ColourGradient bgGrad(
@@ -439,7 +538,7 @@ void HilbertEnvelopeEditor::paint(juce::Graphics& g)
     // Footer text
     g.setColour(juce::Colour(120, 125, 130));
     g.setFont(juce::FontOptions(10.0f, juce::Font::plain));
-    g.drawText("21-tap FIR Hilbert Transform | Phase-Independent Amplitude Detection",
+    g.drawText("Hilbert Transform Envelope | Phase-Independent Amplitude Detection",
         0, getHeight() - 25, getWidth(), 20, juce::Justification::centred);
 
     // Draw subtle grid pattern in background
@@ -457,6 +556,8 @@ void HilbertEnvelopeEditor::paint(juce::Graphics& g)
 //==============================================================================
 void HilbertEnvelopeEditor::resized()
 {
+    background.invalidate();
+
     auto area = getLocalBounds();
 
     // Title area (top 100px)
@@ -468,7 +569,12 @@ void HilbertEnvelopeEditor::resized()
     // Mode selector area (below title)
     auto modeArea = area.removeFromTop(40);
     modeLabel.setBounds(modeArea.removeFromLeft(150).reduced(5));
-    modeSelector.setBounds(modeArea.reduced(5));
+    modeSelector.setBounds(modeArea.removeFromLeft(modeArea.getWidth() / 3).reduced(5));
+    linkSelector.setBounds(modeArea.removeFromLeft(100).reduced(5));
+    engineLabel.setBounds(modeArea.removeFromLeft(80).reduced(5));
+    precisionSelector.setBounds(modeArea.removeFromRight(120).reduced(5));
+    qualitySelector.setBounds(modeArea.removeFromRight(100).reduced(5));
+    engineSelector.setBounds(modeArea.reduced(5));
 
     // Knob area (next 150px)
     auto knobArea = area.removeFromTop(150);
@@ -499,15 +605,50 @@ void HilbertEnvelopeEditor::resized()
     // Right: Scope (takes remaining space)
     auto scopeArea = bottomArea.reduced(10, 15);
     scopeLabel.setBounds(scopeArea.removeFromTop(20));
+    if (StageProfiler::isEnabled)
+        profileLabel.setBounds(scopeArea.removeFromBottom(108).withTrimmedTop(6));
+    analysisLabel.setBounds(scopeArea.removeFromBottom(18));
     envelopeScope.setBounds(scopeArea);
 }
 
 //==============================================================================
-void HilbertEnvelopeEditor::timerCallback()
+void HilbertEnvelopeEditor::updateAnalysisText(bool onsetSeen)
 {
-    updateDisplays();
+    const auto& frame = latestAnalysis;
+    const float rmsDb = 20.0f * std::log10(juce::jmax(frame.rms, 1.0e-5f));
+
+    analysisLabel.setText("RMS " + juce::String(rmsDb, 1) + " dB"
+                          + " | CREST " + juce::String(frame.crestFactor, 2)
+                          + " | FREQ " + juce::String(juce::roundToInt(frame.frequency)) + " Hz"
+                          + " | ONSETS " + juce::String(numOnsets),
+                          juce::dontSendNotification);
+    analysisLabel.setColour(juce::Label::textColourId, onsetSeen ? juce::Colour(255, 120, 80) : juce::Colour(180, 180, 180));
 }
 
+//==============================================================================
+void HilbertEnvelopeEditor::updateProfileText()
+{
+    const float deadline = profileSnapshot.deadlineMicros;
+    const auto& rowNames = StageProfiler::getRowNames();
+
+    // Share of the block deadline at p99, the figure that decides dropouts
+    juce::String text = "STAGE         p50 us    p99 us    max us   p99 load  (block " + juce::String(deadline / 1000.0f, 2) + " ms)\n";
+    for (int row = 0; row < static_cast<int>(profileSnapshot.rows.size()); ++row)
+    {
+        const auto& stats = profileSnapshot.rows[static_cast<size_t>(row)];
+        const float load = deadline > 0.0f ? 100.0f * stats.p99 / deadline : 0.0f;
+
+        text << rowNames[row].toUpperCase().paddedRight(' ', 10)
+             << juce::String(stats.p50, 1).paddedLeft(' ', 10)
+             << juce::String(stats.p99, 1).paddedLeft(' ', 10)
+             << juce::String(stats.max, 1).paddedLeft(' ', 10)
+             << (juce::String(load, 1) + "%").paddedLeft(' ', 11) << "\n";
+    }
+
+    profileLabel.setText(text, juce::dontSendNotification);
+}
+
+//==============================================================================
 void HilbertEnvelopeEditor::updateDisplays()
 {
     try
@@ -520,8 +661,25 @@ void HilbertEnvelopeEditor::updateDisplays()
         currentEnvelopeMeter.setValue(currentEnv);
         peakEnvelopeMeter.setValue(peakEnv);
 
-        // Update scope with envelope values
-        envelopeScope.pushSample(currentEnv, peakEnv);
+        // Drain every scope frame the audio thread produced since the last vblank
+        if (processor.getScopeFifo().drain([this](const ScopeFrame& frame) { envelopeScope.pushFrame(frame); }) > 0)
+            envelopeScope.repaint();
+
+        // Analysis frames: show the newest, count every onset
+        int newOnsets = 0;
+        if (processor.getEnvelopeAnalyzer().drain([this, &newOnsets](const AnalysisFrame& frame)
+            {
+                latestAnalysis = frame;
+                newOnsets += frame.onsetOffset >= 0 ? 1 : 0;
+            }) > 0)
+        {
+            numOnsets += newOnsets;
+            updateAnalysisText(newOnsets > 0);
+        }
+
+        // New stage timings arrive every few seconds of audio
+        if (processor.getStageProfiler().getLatestSnapshot(profileSnapshot))
+            updateProfileText();
 
         // Get parameter values
         auto& apvts = processor.getValueTreeState();
@@ -563,10 +721,20 @@ void HilbertEnvelopeEditor::updateDisplays()
         {
         case 0: modeStr = " | INSTANT"; break;
         case 1: modeStr = " | SMOOTHED"; break;
-        case 2: modeStr = " | SIDECHAIN"; break;
+        case 2: modeStr = processor.isKeyInputActive() ? " | SIDECHAIN (KEY)" : " | SIDECHAIN"; break;
         default: modeStr = "";
         }
 
+        // The band-split detector has no oversampled path (output oversampling
+        // still applies), so say so rather than let the setting look active
+        const int numBands = static_cast<int>(apvts.getRawParameterValue("bands")->load());
+        if (numBands > 1 && !processor.isKeyInputActive())
+        {
+            modeStr << " | " << numBands << " BANDS";
+            if (apvts.getRawParameterValue("oversampling")->load() > 0.5f)
+                modeStr << " (DETECTOR OVERSAMPLING N/A)";
+        }
+
         // Add peak level info
         juce::String peakStr;
         if (peakEnv > 0.001f)
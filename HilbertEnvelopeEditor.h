@@ -8,6 +8,7 @@
 #include "BlackMetalSliderLNF.h"
 #include "BlackMetalVerticalSliderLNF.h"
 #include "EnvelopeScope.h"
+#include "CachedLayer.h"
 
 //==============================================================================
 // Parameter Knob with LCD AND Block Display
@@ -72,18 +73,24 @@ class VerticalEnvelopeMeter : public juce::Component
 public:
     VerticalEnvelopeMeter();
     void paint(juce::Graphics& g) override;
+    void resized() override;
     void setValue(float newValue);
 
 private:
+    void paintBackground(juce::Graphics& g);
+    float getMeterY(float level) const;
+    juce::Rectangle<int> getTextArea() const;
+
     float value = 0.0f;
+    juce::String valueText = "-∞ dB";
+    CachedLayer background;
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VerticalEnvelopeMeter)
 };
 
 //==============================================================================
 // Main Plugin Editor (UPDATED)
 //==============================================================================
-class HilbertEnvelopeEditor : public juce::AudioProcessorEditor,
-    private juce::Timer
+class HilbertEnvelopeEditor : public juce::AudioProcessorEditor
 {
 public:
     explicit HilbertEnvelopeEditor(HilbertEnvelopeProcessor&);
@@ -116,13 +123,40 @@ private:
     juce::Label meterLabelCurrent;
     juce::Label meterLabelPeak;
     juce::Label scopeLabel;
+    juce::Label profileLabel;
+    juce::Label analysisLabel;
 
     // Mode selector
     juce::ComboBox modeSelector;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> modeAttachment;
 
-    void timerCallback() override;
+    // Channel link selector
+    juce::ComboBox linkSelector;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> linkAttachment;
+
+    // Hilbert engine selector
+    juce::Label engineLabel;
+    juce::ComboBox engineSelector;
+    juce::ComboBox precisionSelector;
+    juce::ComboBox qualitySelector;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> engineAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> precisionAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> qualityAttachment;
+
+    void styleComboBox(juce::ComboBox& box);
+
+    // All display updates are coalesced into one callback per vblank
+    juce::VBlankAttachment vblankAttachment;
+    CachedLayer background;
+
+    void paintBackground(juce::Graphics& g);
     void updateDisplays();
+    void updateProfileText();
+    void updateAnalysisText(bool onsetSeen);
+
+    StageProfiler::Snapshot profileSnapshot;
+    AnalysisFrame latestAnalysis;
+    int numOnsets = 0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HilbertEnvelopeEditor)
 };
\ No newline at end of file
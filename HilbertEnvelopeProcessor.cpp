@@ -5,6 +5,7 @@
 HilbertEnvelopeProcessor::HilbertEnvelopeProcessor()
     : AudioProcessor(BusesProperties()
         .withInput("Input", juce::AudioChannelSet::stereo(), true)
+        .withInput("Sidechain", juce::AudioChannelSet::stereo(), false)
         .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
     parameters(*this, nullptr, "HilbertParams", {
       std::make_unique<juce::AudioParameterFloat>("mix", "Mix",
@@ -16,7 +17,37 @@ HilbertEnvelopeProcessor::HilbertEnvelopeProcessor()
       std::make_unique<juce::AudioParameterFloat>("release", "Release",
           juce::NormalisableRange<float>(1.0f, 2000.0f, 0.1f), 100.0f),
       std::make_unique<juce::AudioParameterChoice>("mode", "Mode",
-          juce::StringArray{"Instant", "Smoothed", "Sidechain"}, 0)
+          juce::StringArray{"Instant", "Smoothed", "Sidechain"}, 0),
+      std::make_unique<juce::AudioParameterChoice>("engine", "Engine",
+          juce::StringArray{"Standard", "High Precision", "Low Latency"}, 0),
+      std::make_unique<juce::AudioParameterChoice>("precision", "Precision Taps",
+          HilbertFftConvolver::getKernelLengthNames(), 2),
+      std::make_unique<juce::AudioParameterChoice>("quality", "Quality",
+          HilbertKernelDesign::getQualityNames(), taps31),
+      std::make_unique<juce::AudioParameterChoice>("saturation", "Saturation",
+          Saturation::getQualityNames(), Saturation::fast),
+      std::make_unique<juce::AudioParameterChoice>("link", "Channel Link",
+          juce::StringArray{"Off", "Max", "RMS", "Mid"}, 0),
+      std::make_unique<juce::AudioParameterChoice>("oversampling", "Oversampling",
+          juce::StringArray{"Off", "2x", "4x", "8x"}, 0),
+      std::make_unique<juce::AudioParameterBool>("oversampleOutput", "Oversample Output", false),
+      std::make_unique<juce::AudioParameterFloat>("lookahead", "Lookahead",
+          juce::NormalisableRange<float>(0.0f, maxLookaheadMs, 0.1f), 0.0f),
+      std::make_unique<juce::AudioParameterFloat>("hold", "Hold (ms)",
+          juce::NormalisableRange<float>(0.0f, maxHoldMs, 1.0f, 0.3f), 0.0f),
+      std::make_unique<juce::AudioParameterInt>("bands", "Bands", 1, maxBands, 1),
+      std::make_unique<juce::AudioParameterFloat>("controlRate", "Control Rate (Hz)",
+          juce::NormalisableRange<float>(10.0f, 1000.0f, 1.0f, 0.4f), 100.0f),
+      std::make_unique<juce::AudioParameterInt>("controlThreshold", "Control Threshold", 1, 16, 1),
+      std::make_unique<juce::AudioParameterBool>("midiOutput", "MIDI CC Output", false),
+      std::make_unique<juce::AudioParameterInt>("midiCc", "MIDI CC Number", 0, 119, 1),
+      std::make_unique<juce::AudioParameterInt>("midiChannel", "MIDI Channel", 1, 16, 1),
+      // Read-only modulation source: hosts that route output parameters can map
+      // it. Not automatable and not part of the saved state
+      std::make_unique<juce::AudioParameterFloat>("envelopeOut", "Envelope Out",
+          juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f,
+          juce::AudioParameterFloatAttributes().withCategory(juce::AudioProcessorParameter::outputMeter)
+                                               .withAutomatable(false))
         })
 {
     mixParam = parameters.getRawParameterValue("mix");
@@ -24,216 +55,898 @@ HilbertEnvelopeProcessor::HilbertEnvelopeProcessor()
     attackParam = parameters.getRawParameterValue("attack");
     releaseParam = parameters.getRawParameterValue("release");
     modeParam = parameters.getRawParameterValue("mode");
+    engineParam = parameters.getRawParameterValue("engine");
+    precisionParam = parameters.getRawParameterValue("precision");
+    qualityParam = parameters.getRawParameterValue("quality");
+    saturationParam = parameters.getRawParameterValue("saturation");
+    linkParam = parameters.getRawParameterValue("link");
+    oversamplingParam = parameters.getRawParameterValue("oversampling");
+    oversampleOutputParam = parameters.getRawParameterValue("oversampleOutput");
+    lookaheadParam = parameters.getRawParameterValue("lookahead");
+    holdParam = parameters.getRawParameterValue("hold");
+    bandsParam = parameters.getRawParameterValue("bands");
+    controlRateParam = parameters.getRawParameterValue("controlRate");
+    controlThresholdParam = parameters.getRawParameterValue("controlThreshold");
+    midiOutputParam = parameters.getRawParameterValue("midiOutput");
+    midiCcParam = parameters.getRawParameterValue("midiCc");
+    midiChannelParam = parameters.getRawParameterValue("midiChannel");
+    envelopeOutParam = dynamic_cast<juce::AudioParameterFloat*>(parameters.getParameter("envelopeOut"));
+}
 
-    initializeHilbertFilter();
+HilbertEnvelopeProcessor::~HilbertEnvelopeProcessor()
+{
+    stopTimer();
 }
 
-HilbertEnvelopeProcessor::~HilbertEnvelopeProcessor() {}
+void HilbertEnvelopeProcessor::timerCallback()
+{
+    // Latency changes follow parameter moves picked up by the audio thread
+    const int latency = pendingLatency.load();
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+
+    const float envelopeOut = envelopeOutValue.load();
+    if (envelopeOutParam != nullptr && envelopeOut != envelopeOutParam->get())
+        envelopeOutParam->setValueNotifyingHost(envelopeOut);
+}
 
-void HilbertEnvelopeProcessor::initializeHilbertFilter()
+template <typename SampleType>
+SampleType HilbertEnvelopeProcessor::createOutput(SampleType input, SampleType envelope, float mix, float gain)
+{
+    // FIXED: Use modulation approach instead of additive mixing
+    // envelope is 0-1, so when mix=1, output = input * envelope
+    // when mix=0, output = input * 1.0 (dry)
+    SampleType modulationFactor = (1.0f - mix) + mix * envelope;
+    SampleType modulated = input * modulationFactor;
+
+    // Softer clipping with tanh: the drive goes into the block-wise
+    // saturation stage (see Saturation.h)
+    return modulated * gain * 0.5f;
+}
+
+template <typename SampleType>
+SampleType HilbertEnvelopeProcessor::createDuckedOutput(SampleType input, SampleType keyEnvelope, float mix, float gain)
+{
+    // The key envelope pulls the main signal down: mix=1 with a full scale key
+    // silences it, mix=0 leaves it dry
+    SampleType modulationFactor = 1.0f - mix * juce::jlimit(static_cast<SampleType>(0), static_cast<SampleType>(1), keyEnvelope);
+    return input * modulationFactor * gain * 0.5f;
+}
+
+void HilbertEnvelopeProcessor::updateSmoothingCoefficients()
 {
-    // FIXED: 31-tap Hilbert transformer (removed trailing zeros)
-    hilbertCoeffs = {
-        -0.0164f, 0.0f, -0.0265f, 0.0f, -0.0452f, 0.0f, -0.0909f, 0.0f,
-        -0.3129f, 0.0f, -0.5000f, 0.0f, -0.3129f, 0.0f, -0.0909f, 0.0f,
-        -0.0452f, 0.0f, -0.0265f, 0.0f, -0.0164f  // REMOVED: , -0.0103f, 0.0f, -0.0060f, 0.0f, -0.0030f, 0.0f, -0.0012f, 0.0f, -0.0003f, 0.0f
+    const float attackMs = attackParam->load();
+    const float releaseMs = releaseParam->load();
+
+    if (attackMs != lastAttackMs)
+    {
+        lastAttackMs = attackMs;
+
+        // For very short times, ensure coefficients don't go to 0
+        attackCoeffRamp.setTargetValue(juce::jlimit(0.0001f, 0.9999f, timeConstants.getCoefficient(attackMs)));
+    }
+
+    if (releaseMs != lastReleaseMs)
+    {
+        lastReleaseMs = releaseMs;
+        releaseCoeffRamp.setTargetValue(juce::jlimit(0.0001f, 0.9999f, timeConstants.getCoefficient(releaseMs)));
+
+        // The display peak hold decays ten times slower than the release
+        peakReleaseCoeff = timeConstants.getCoefficient(releaseMs * 10.0f);
+    }
+}
+
+void HilbertEnvelopeProcessor::fillCoefficientRamps(int numSamples)
+{
+    auto fill = [numSamples](juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>& ramp, float* destination)
+    {
+        if (!ramp.isSmoothing())
+        {
+            juce::FloatVectorOperations::fill(destination, ramp.getTargetValue(), numSamples);
+            return;
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+            destination[i] = ramp.getNextValue();
     };
-    filterTaps = static_cast<int>(hilbertCoeffs.size());  // Now 21
+
+    fill(attackCoeffRamp, attackCoeffScratch.data());
+    fill(releaseCoeffRamp, releaseCoeffScratch.data());
 }
 
-float HilbertEnvelopeProcessor::processEnvelopeSmoothing(float input, float currentState,
-    float attackCoeff, float releaseCoeff)
+HilbertBackend& HilbertEnvelopeProcessor::getBackend(int engine, int quality, int oversampling)
 {
-    if (input > currentState)
+    switch (engine)
     {
-        // Rising: use attack coefficient
-        return attackCoeff * currentState + (1.0f - attackCoeff) * input;
+    case highPrecisionEngine: return hilbertFft;
+    case lowLatencyEngine: return hilbertIir;
+    default: break;
     }
-    else
+
+    // Doubling the kernel with the rate keeps its low band edge in Hz
+    switch (quality + oversampling)
     {
-        // Falling: use release coefficient
-        return releaseCoeff * currentState + (1.0f - releaseCoeff) * input;
+    case taps15: return hilbertFir15;
+    case taps63: return hilbertFir63;
+    case taps127: return hilbertFir127;
+    case taps255: return hilbertFir255;
+    case taps511: return hilbertFir511;
+    case taps1023: return hilbertFir1023;
+    default: return hilbertFir31;
     }
 }
 
-float HilbertEnvelopeProcessor::createOutput(float input, float envelope, float mix, float gain)
+template <typename SampleType>
+void HilbertEnvelopeProcessor::updateHilbertEngine(bool bandSplit)
 {
-    // FIXED: Use modulation approach instead of additive mixing
-    // envelope is 0-1, so when mix=1, output = input * envelope
-    // when mix=0, output = input * 1.0 (dry)
-    float modulationFactor = (1.0f - mix) + mix * envelope;
-    float modulated = input * modulationFactor;
+    auto& dsp = getDsp<SampleType>();
+    const int engine = static_cast<int>(engineParam->load());
+    const int quality = static_cast<int>(qualityParam->load());
+    const int oversampling = static_cast<int>(oversamplingParam->load());
+
+    // The backend runs at the detector's rate, so its kernel grows (or the IIR
+    // pair is warped) with the oversampling factor to keep the band's low edge
+    // where it is at the base rate. The band-split path runs it at the base rate
+    const int backendOversampling = bandSplit ? 0 : oversampling;
+    hilbertFft.setKernelLengthIndex(static_cast<int>(precisionParam->load()) + backendOversampling);
+    hilbertIir.setOversamplingFactor(1 << backendOversampling);
+
+    // Start the newly selected engine (or rate) from silence rather than stale history
+    if (engine != activeEngine || quality != activeQuality || oversampling != activeOversampling)
+    {
+        activeEngine = engine;
+        activeQuality = quality;
+        activeOversampling = oversampling;
+        activeBackend = &getBackend(engine, quality, backendOversampling);
+        activeBackend->reset();
+
+        if (oversampling > 0)
+            dsp.detectorOversamplers[oversampling - 1]->reset();
+    }
 
-    // Softer clipping with tanh
-    return std::tanh(modulated * gain * 0.5f);
+    // The band-split path only runs the backend for the analyser and delays
+    // the bands rather than the dry signal; start everything from silence
+    // when switching between the two
+    if (bandSplit != activeBandSplit)
+    {
+        activeBandSplit = bandSplit;
+        activeBackend = &getBackend(engine, quality, backendOversampling);
+        activeBackend->reset();
+        dsp.dryDelay.reset();
+        dsp.bandSplitBank.reset();
+        dsp.bandFollower.reset();
+        dsp.bandDelay.reset();
+    }
+
+    // The output stage only gets its own filters when asked to
+    const bool oversampleOutput = oversampling > 0 && oversampleOutputParam->load() >= 0.5f;
+    if (oversampleOutput != activeOutputOversampling)
+    {
+        activeOutputOversampling = oversampleOutput;
+        if (oversampleOutput)
+            dsp.outputOversamplers[oversampling - 1]->reset();
+    }
+
+    // The detector sees the audio lookahead samples before the delayed dry path
+    const int lookahead = juce::roundToInt(lookaheadParam->load() * 0.001 * sampleRate);
+
+    // Report the detector + lookahead (+ output stage) latency so hosts compensate,
+    // and line the dry path up with the detector, lookahead samples late. The
+    // band-split path builds its output from the bands themselves, which have
+    // no detector latency and are only held back by the lookahead
+    const int dryLatency = activeBandSplit ? lookahead : getDetectorLatency<SampleType>() + lookahead;
+    const int latency = dryLatency + (activeOutputOversampling
+        ? juce::roundToInt(dsp.outputOversamplers[activeOversampling - 1]->getLatencyInSamples()) : 0);
+    pendingLatency.store(latency);  // reported by timerCallback (or prepareToPlay)
+
+    dsp.dryDelay.setDelay(static_cast<SampleType>(dryLatency));
+    dsp.bandDelay.setDelay(static_cast<SampleType>(lookahead));
+    envelopeLatency = activeBandSplit ? 0 : getDetectorLatency<SampleType>();
+
+    // The analyser taps the Hilbert pair ahead of any downsampling, so only
+    // the upsampling half of the oversampler delays it. The band-split path
+    // runs the backend at the base rate, for the analyser alone
+    int analyticLatency = activeBackend->getLatencySamples();
+    if (activeOversampling > 0 && !activeBandSplit)
+    {
+        const auto& oversampler = *dsp.detectorOversamplers[activeOversampling - 1];
+        analyticLatency = juce::roundToInt(static_cast<float>(analyticLatency) / static_cast<float>(oversampler.getOversamplingFactor())
+                                           + oversampler.getLatencyInSamples() * 0.5f);
+    }
+    envelopeAnalyzer.setLatency(analyticLatency);
 }
 
-void HilbertEnvelopeProcessor::pushScopeSample(float env, float peak)
+template <typename SampleType>
+void HilbertEnvelopeProcessor::resetDsp()
 {
-    scopeCurrentEnvelope.store(env);
-    scopePeakEnvelope.store(peak);
+    auto& dsp = getDsp<SampleType>();
+
+    for (auto* oversamplers : { &dsp.detectorOversamplers, &dsp.outputOversamplers })
+        for (auto& oversampler : *oversamplers)
+            oversampler->reset();
+
+    dsp.dryDelay.reset();
+    dsp.envelopeFollower.reset();
+    dsp.bandSplitBank.reset();
+    dsp.bandFollower.reset();
+    dsp.bandDelay.reset();
+    activeBackend->reset();
 }
 
-void HilbertEnvelopeProcessor::updateSmoothingCoefficients()
+template <typename SampleType>
+int HilbertEnvelopeProcessor::getDetectorLatency()
 {
-    // Convert milliseconds to seconds
-    const float attackTimeS = attackParam->load() * 0.001f;
-    const float releaseTimeS = releaseParam->load() * 0.001f;
+    if (activeOversampling == 0)
+        return activeBackend->getLatencySamples();
 
-    // Calculate target coefficients using exponential formula
-    targetAttackCoeff = std::exp(-1.0f / (attackTimeS * static_cast<float>(sampleRate)));
-    targetReleaseCoeff = std::exp(-1.0f / (releaseTimeS * static_cast<float>(sampleRate)));
+    // The backend runs at the oversampled rate
+    const auto& oversampler = *getDsp<SampleType>().detectorOversamplers[activeOversampling - 1];
+    return juce::roundToInt(static_cast<float>(activeBackend->getLatencySamples()) / static_cast<float>(oversampler.getOversamplingFactor())
+                            + oversampler.getLatencyInSamples());
+}
 
-    // For very short times, ensure coefficients don't go to 0
-    targetAttackCoeff = juce::jlimit(0.0001f, 0.9999f, targetAttackCoeff);
-    targetReleaseCoeff = juce::jlimit(0.0001f, 0.9999f, targetReleaseCoeff);
+template <typename SampleType>
+void HilbertEnvelopeProcessor::delaySignal(SampleDelay<SampleType>& delay, int channel, SampleType* data, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        delay.pushSample(channel, data[i]);
+        data[i] = delay.popSample(channel);
+    }
+}
+
+template <typename SampleType>
+void HilbertEnvelopeProcessor::prepareDsp(int numChannels)
+{
+    auto& dsp = getDsp<SampleType>();
+    dsp.hilbertScratch.assign(maxBlockSize * maxOversamplingFactor, static_cast<SampleType>(0));
+    dsp.realScratch.assign(maxBlockSize * maxOversamplingFactor, static_cast<SampleType>(0));
+    dsp.detectorScratch.assign(maxBlockSize, static_cast<SampleType>(0));
+    dsp.envelopeScratch.setSize(numChannels, maxBlockSize);
+    dsp.envelopeFollower.prepare(numChannels);
+    dsp.fastTanhKernel = Saturation::getFastTanhKernel<SampleType>();
+
+    // Linear phase half-band stages with integer latency, so the dry delay can match them
+    int maxOversamplingLatency = 0;
+    for (size_t i = 0; i < dsp.detectorOversamplers.size(); ++i)
+    {
+        for (auto* oversamplers : { &dsp.detectorOversamplers, &dsp.outputOversamplers })
+        {
+            (*oversamplers)[i] = std::make_unique<juce::dsp::Oversampling<SampleType>>(
+                static_cast<size_t>(numChannels), i + 1,
+                juce::dsp::Oversampling<SampleType>::filterHalfBandFIREquiripple, true, true);
+            (*oversamplers)[i]->initProcessing(static_cast<size_t>(maxBlockSize));
+        }
+
+        maxOversamplingLatency = juce::jmax(maxOversamplingLatency,
+            juce::roundToInt(dsp.detectorOversamplers[i]->getLatencyInSamples()));
+    }
+    activeOversampling = -1;
+    activeOutputOversampling = false;
+
+    // One band set per channel plus one for the "Mid" link's split
+    dsp.bandSplitBank.prepare(sampleRate, numChannels + 1);
+    dsp.bandSignalScratch.setSize((numChannels + 1) * maxBands, maxBlockSize);
+    dsp.bandEnvelopeScratch.setSize((numChannels + 1) * maxBands, maxBlockSize);
+    dsp.bandFollower.prepare((numChannels + 1) * maxBands);
+
+    // Sized once for the longest engine + lookahead, so the parameters never reallocate it
+    const int maxLookahead = static_cast<int>(std::ceil(maxLookaheadMs * 0.001 * sampleRate));
+    dsp.dryDelay.setMaximumDelayInSamples(HilbertFftConvolver::getMaxLatencySamples() + maxOversamplingLatency + maxLookahead);
+    dsp.dryDelay.prepare({ sampleRate, static_cast<juce::uint32>(maxBlockSize),
+                           static_cast<juce::uint32>(numChannels) });
+    dsp.bandDelay.setMaximumDelayInSamples(maxLookahead);
+    dsp.bandDelay.prepare({ sampleRate, static_cast<juce::uint32>(maxBlockSize),
+                            static_cast<juce::uint32>(numChannels * maxBands) });
+    updateHilbertEngine<SampleType>(static_cast<int>(bandsParam->load()) > 1);
 }
 
 void HilbertEnvelopeProcessor::prepareToPlay(double newSampleRate, int samplesPerBlock)
 {
     sampleRate = newSampleRate;
-    hilbertBuffer.assign(filterTaps, 0.0f);
-    bufferIndex = 0;
+    maxBlockSize = juce::jmax(1, samplesPerBlock);
+    attackCoeffScratch.assign(maxBlockSize, 0.0f);
+    releaseCoeffScratch.assign(maxBlockSize, 0.0f);
+
+    // Everything is sized for the largest supported layout, so processBlock
+    // never allocates whatever the host's bus layout or key channel count
+    const int numChannels = maxSupportedChannels;
+    hilbertFir15.prepare(numChannels, maxBlockSize * maxOversamplingFactor);
+    hilbertFir31.prepare(numChannels, maxBlockSize * maxOversamplingFactor);
+    hilbertFir63.prepare(numChannels, maxBlockSize * maxOversamplingFactor);
+    hilbertFir127.prepare(numChannels, maxBlockSize * maxOversamplingFactor);
+    hilbertFir255.prepare(numChannels, maxBlockSize * maxOversamplingFactor);
+    hilbertFir511.prepare(numChannels, maxBlockSize * maxOversamplingFactor);
+    hilbertFir1023.prepare(numChannels, maxBlockSize * maxOversamplingFactor);
+    hilbertFft.prepare(numChannels, maxBlockSize * maxOversamplingFactor);
+    hilbertIir.prepare(numChannels, maxBlockSize * maxOversamplingFactor);
+
+    // Both precisions get buffers, the one the host asked for last so the
+    // engine state and latency are its own
+    processingDouble = isUsingDoublePrecision();
+    if (processingDouble)
+    {
+        prepareDsp<float>(numChannels);
+        prepareDsp<double>(numChannels);
+    }
+    else
+    {
+        prepareDsp<double>(numChannels);
+        prepareDsp<float>(numChannels);
+    }
+
+    // Hosts read the latency as soon as this returns
+    setLatencySamples(pendingLatency.load());
+
     currentEnvelope = 0.0f;
     peakEnvelope = 0.0f;
-    scopeCurrentEnvelope = 0.0f;
-    scopePeakEnvelope = 0.0f;
-
-    // Initialize smoothing coefficients
+    scopeFifo.prepare(sampleRate);
+    stageProfiler.prepare(sampleRate);
+    envelopeAnalyzer.prepare(sampleRate);
+    peakHoldScratch.assign(static_cast<size_t>(maxBlockSize), 0.0f);
+    controlOutput.prepare(sampleRate);
+
+    // Initialize smoothing coefficients: 10 ms ramps, starting at the targets
+    timeConstants.prepare(sampleRate);
+    attackCoeffRamp.reset(sampleRate, 0.01);
+    releaseCoeffRamp.reset(sampleRate, 0.01);
+    lastAttackMs = lastReleaseMs = -1.0f;
     updateSmoothingCoefficients();
-    currentAttackCoeff = targetAttackCoeff;
-    currentReleaseCoeff = targetReleaseCoeff;
+    attackCoeffRamp.setCurrentAndTargetValue(attackCoeffRamp.getTargetValue());
+    releaseCoeffRamp.setCurrentAndTargetValue(releaseCoeffRamp.getTargetValue());
 
-    // Initialize channel states
-    channelStates.clear();
+    // Initialize channel states, with the peak hold windows sized for the longest hold
+    const int maxHoldSamples = static_cast<int>(std::ceil(maxHoldMs * 0.001 * sampleRate));
+    channelStates.assign(static_cast<size_t>(numChannels), {});
+    for (auto& state : channelStates)
+        state.peakWindow.prepare(maxHoldSamples);
+
+    startTimerHz(30);
 }
 
-void HilbertEnvelopeProcessor::releaseResources() {}
+void HilbertEnvelopeProcessor::releaseResources()
+{
+    stopTimer();
+}
 
-void HilbertEnvelopeProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+template <int mode, typename SampleType>
+void HilbertEnvelopeProcessor::processChannels(juce::AudioBuffer<SampleType>& mainBuffer,
+    const juce::AudioBuffer<SampleType>& keyBuffer, float mix, float gain, int saturation, int link,
+    BlockMeters& meters)
 {
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
+    constexpr bool keyed = mode == keyedSidechainMode;
+    auto& dsp = getDsp<SampleType>();
+    const int numSamples = mainBuffer.getNumSamples();
+    const int numChannels = mainBuffer.getNumChannels();
+    const auto& detectorBuffer = keyed ? keyBuffer : static_cast<const juce::AudioBuffer<SampleType>&>(mainBuffer);
+    const int numDetectorChannels = detectorBuffer.getNumChannels();
+    const int numEnvelopes = link == linkOff ? numDetectorChannels : 1;
+    auto* const* envelopes = dsp.envelopeScratch.getArrayOfWritePointers();
+
+    for (int start = 0; start < numSamples; start += maxBlockSize)
+    {
+        const int blockLength = juce::jmin(maxBlockSize, numSamples - start);
 
-    // Clear any output channels that don't contain input data
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear(i, 0, buffer.getNumSamples());
+        // Stage 1: analytic signal (90 degree phase shift) and instantaneous
+        // envelope of every detector channel, read straight from the host buffer.
+        // Linked detection folds them into one envelope in envelopes[0]
+        {
+            const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::hilbertStage);
 
-    const int numSamples = buffer.getNumSamples();
-    const float mix = mixParam->load();
-    const float gain = gainParam->load();
-    const int mode = static_cast<int>(modeParam->load());
+            if (link == linkMid)
+            {
+                // A single Hilbert pass on the average of the detector channels
+                juce::FloatVectorOperations::copy(dsp.detectorScratch.data(), detectorBuffer.getReadPointer(0, start), blockLength);
+                for (int channel = 1; channel < numDetectorChannels; ++channel)
+                    juce::FloatVectorOperations::add(dsp.detectorScratch.data(), detectorBuffer.getReadPointer(channel, start), blockLength);
+                juce::FloatVectorOperations::multiply(dsp.detectorScratch.data(), static_cast<SampleType>(1) / static_cast<SampleType>(numDetectorChannels), blockLength);
+
+                const SampleType* mid = dsp.detectorScratch.data();
+                computeDetectorPower(&mid, 1, blockLength);
+            }
+            else
+            {
+                const SampleType* detectorInputs[maxSupportedChannels];
+                for (int channel = 0; channel < numDetectorChannels; ++channel)
+                    detectorInputs[channel] = detectorBuffer.getReadPointer(channel, start);
+
+                computeDetectorPower(detectorInputs, numDetectorChannels, blockLength);
+
+                // max |a| = sqrt(max |a|^2), so both links combine the powers
+                for (int channel = 1; channel < numDetectorChannels && link != linkOff; ++channel)
+                {
+                    if (link == linkMax)
+                        juce::FloatVectorOperations::max(envelopes[0], envelopes[0], envelopes[channel], blockLength);
+                    else
+                        juce::FloatVectorOperations::add(envelopes[0], envelopes[channel], blockLength);
+                }
+
+                if (link == linkRms)
+                    juce::FloatVectorOperations::multiply(envelopes[0], static_cast<SampleType>(1) / static_cast<SampleType>(numDetectorChannels), blockLength);
+            }
 
-    // Update target coefficients
-    updateSmoothingCoefficients();
+            for (int channel = 0; channel < numEnvelopes; ++channel)
+            {
+                SampleType* envelope = envelopes[channel];
+                for (int j = 0; j < blockLength; ++j)
+                    envelope[j] = std::sqrt(envelope[j]);
+            }
+        }
 
-    // Smooth coefficient changes over time to prevent clicks
-    const float paramSlewCoeff = std::exp(-1.0f / (0.01f * static_cast<float>(sampleRate)));
-    currentAttackCoeff = paramSlewCoeff * currentAttackCoeff + (1.0f - paramSlewCoeff) * targetAttackCoeff;
-    currentReleaseCoeff = paramSlewCoeff * currentReleaseCoeff + (1.0f - paramSlewCoeff) * targetReleaseCoeff;
+        // Delay the dry signal to line up with the envelope
+        {
+            const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::outputStage);
+            for (int channel = 0; channel < numChannels; ++channel)
+                delaySignal(dsp.dryDelay, channel, mainBuffer.getWritePointer(channel, start), blockLength);
+        }
 
-    // Ensure channel states vector is properly sized
-    if (channelStates.size() != totalNumInputChannels)
-    {
-        channelStates.resize(totalNumInputChannels);
-    }
+        // Stage 2: attack/release smoothing, channels side by side in SIMD lanes.
+        // The coefficient ramps advance in every mode so switching modes picks
+        // up the current values
+        {
+            const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::smoothingStage);
+            fillCoefficientRamps(blockLength);
+            if constexpr (mode != instantMode)
+                dsp.envelopeFollower.process(envelopes, numEnvelopes, blockLength,
+                    attackCoeffScratch.data(), releaseCoeffScratch.data());
+        }
+
+        // Stage 3: peak detector and metering, once per envelope
+        for (int channel = 0; channel < numEnvelopes; ++channel)
+            updatePeakAndMeters(channel, envelopes[channel], blockLength, meters);
+
+        // Stage 4: output. Envelope k drives main channels k, k + numEnvelopes, ...
+        // (a mono key or a linked envelope drives all of them)
+        const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::outputStage);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* channelData = mainBuffer.getWritePointer(channel, start);
+            const SampleType* envelope = envelopes[channel % numEnvelopes];
+            captureEnvelope(channel, start, envelope, blockLength);
+
+            // Create output based on mode (soft clipped block-wise below)
+            for (int j = 0; j < blockLength; ++j)
+            {
+                if constexpr (mode == sidechainMode)  // Sidechain mode without a key: output ONLY the envelope
+                    channelData[j] = envelope[j] * 0.707f * gain;  // -3dB scaling
+                else if constexpr (keyed)  // Sidechain mode with a key: duck the dry signal
+                    channelData[j] = createDuckedOutput(channelData[j], envelope[j], mix, gain);
+                else  // Instant or Smoothed mode: modulate the dry signal
+                    channelData[j] = createOutput(channelData[j], envelope[j], mix, gain);
+            }
+        }
 
-    // Track overall peak for display
-    float blockPeak = 0.0f;
-    float overallEnvelopeSum = 0.0f;
+        // Soft clipping for the whole chunk: the modulated signal goes through
+        // createOutput's drive stage and the final clip (merged into one stage
+        // in "Fast Single Stage"), the sidechain envelope only the final clip
+        applySaturation(mainBuffer, start, blockLength, mode == sidechainMode ? 1 : Saturation::getNumStages(saturation), saturation);
+    }
+}
 
-    // Process each channel
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+template <int mode, typename SampleType>
+void HilbertEnvelopeProcessor::processBands(juce::AudioBuffer<SampleType>& mainBuffer, float mix, float gain,
+    int saturation, int link, BlockMeters& meters)
+{
+    auto& dsp = getDsp<SampleType>();
+    const int numSamples = mainBuffer.getNumSamples();
+    const int numChannels = mainBuffer.getNumChannels();
+    const int numBands = dsp.bandSplitBank.getNumBands();
+    auto* const* bandSignals = dsp.bandSignalScratch.getArrayOfWritePointers();
+    auto* const* bandEnvelopes = dsp.bandEnvelopeScratch.getArrayOfWritePointers();
+    auto* const* loudestBands = dsp.envelopeScratch.getArrayOfWritePointers();
+    const bool lookahead = dsp.bandDelay.getDelay() > 0;
+
+    // Band sets are maxBands scratch rows each: one per channel, then the
+    // "Mid" link's split of the channel average. Linked detection folds the
+    // channels' band envelopes into a single set, band by band
+    const int midSet = dsp.bandSignalScratch.getNumChannels() / maxBands - 1;
+    const int numEnvelopeSets = link == linkOff ? numChannels : 1;
+    const auto firstEnvelopeRow = [&](int set) { return (link == linkMid ? midSet : set) * maxBands; };
+
+    for (int start = 0; start < numSamples; start += maxBlockSize)
     {
-        auto* channelData = buffer.getWritePointer(channel);
-        auto& state = channelStates[channel];
+        const int blockLength = juce::jmin(maxBlockSize, numSamples - start);
 
-        // Initialize peak release coefficient from release parameter
-        const float releaseTimeS = releaseParam->load() * 0.001f;
-        state.peakReleaseCoeff = std::exp(-1.0f / (releaseTimeS * 10.0f * static_cast<float>(sampleRate)));
+        // The analyser wants the broadband pair, which the bands don't give, so
+        // the otherwise idle Hilbert backend runs on the first channel for it
+        {
+            const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::analysisStage);
+            activeBackend->process(0, mainBuffer.getReadPointer(0, start), dsp.realScratch.data(), dsp.hilbertScratch.data(), blockLength);
+            envelopeAnalyzer.process(dsp.realScratch.data(), dsp.hilbertScratch.data(), blockLength, 1);
+        }
 
-        for (int i = 0; i < numSamples; ++i)
+        // Stage 1: split every channel into bands and take every band's analytic envelope
         {
-            float input = channelData[i];
+            const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::hilbertStage);
 
-            // Update delay line
-            hilbertBuffer[bufferIndex] = input;
+            for (int channel = 0; channel < numChannels; ++channel)
+                dsp.bandSplitBank.process(channel, mainBuffer.getReadPointer(channel, start),
+                    bandSignals + channel * maxBands, bandEnvelopes + channel * maxBands, blockLength);
 
-            // Compute Hilbert transform (90° phase shift)
-            float hilbert = 0.0f;
-            for (int n = 0; n < filterTaps; ++n)
+            if (link == linkMid)
+            {
+                // One more split of the average of the channels
+                juce::FloatVectorOperations::copy(dsp.detectorScratch.data(), mainBuffer.getReadPointer(0, start), blockLength);
+                for (int channel = 1; channel < numChannels; ++channel)
+                    juce::FloatVectorOperations::add(dsp.detectorScratch.data(), mainBuffer.getReadPointer(channel, start), blockLength);
+                juce::FloatVectorOperations::multiply(dsp.detectorScratch.data(), static_cast<SampleType>(1) / static_cast<SampleType>(numChannels), blockLength);
+
+                dsp.bandSplitBank.process(midSet, dsp.detectorScratch.data(),
+                    bandSignals + midSet * maxBands, bandEnvelopes + midSet * maxBands, blockLength);
+            }
+            else if (link != linkOff)
             {
-                int idx = (bufferIndex + n) % filterTaps;
-                hilbert += hilbertCoeffs[n] * hilbertBuffer[idx];
+                for (int band = 0; band < numBands; ++band)
+                {
+                    SampleType* linked = bandEnvelopes[band];
+
+                    if (link == linkRms)
+                        juce::FloatVectorOperations::multiply(linked, linked, blockLength);
+
+                    for (int channel = 1; channel < numChannels; ++channel)
+                    {
+                        const SampleType* envelope = bandEnvelopes[channel * maxBands + band];
+                        if (link == linkMax)
+                            juce::FloatVectorOperations::max(linked, linked, envelope, blockLength);
+                        else
+                            juce::FloatVectorOperations::addWithMultiply(linked, envelope, envelope, blockLength);
+                    }
+
+                    if (link == linkRms)
+                    {
+                        juce::FloatVectorOperations::multiply(linked, static_cast<SampleType>(1) / static_cast<SampleType>(numChannels), blockLength);
+                        for (int j = 0; j < blockLength; ++j)
+                            linked[j] = std::sqrt(linked[j]);
+                    }
+                }
             }
+        }
 
-            // Compute instantaneous envelope
-            float instantaneousEnvelope = std::sqrt(input * input + hilbert * hilbert);
+        // Stage 2: attack/release smoothing per band, the bands side by side in SIMD lanes
+        {
+            const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::smoothingStage);
+            fillCoefficientRamps(blockLength);
+            if constexpr (mode != instantMode)
+                for (int set = 0; set < numEnvelopeSets; ++set)
+                    dsp.bandFollower.process(bandEnvelopes + firstEnvelopeRow(set), numBands, blockLength,
+                        attackCoeffScratch.data(), releaseCoeffScratch.data(), firstEnvelopeRow(set));
+        }
 
-            // Apply mode-specific processing
-            float envelopeToUse = instantaneousEnvelope;
+        // Stage 3: peak detector and metering follow the loudest band of each set
+        for (int set = 0; set < numEnvelopeSets; ++set)
+        {
+            auto* const* envelopes = bandEnvelopes + firstEnvelopeRow(set);
+            SampleType* loudestBand = loudestBands[set];
 
-            if (mode == 1 || mode == 2)  // Smoothed or Sidechain modes
             {
-                // Apply attack/release smoothing
-                state.smoothedEnvelope = processEnvelopeSmoothing(
-                    instantaneousEnvelope,
-                    state.smoothedEnvelope,
-                    currentAttackCoeff,
-                    currentReleaseCoeff
-                );
-                envelopeToUse = state.smoothedEnvelope;
+                const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::peakStage);
+                juce::FloatVectorOperations::copy(loudestBand, envelopes[0], blockLength);
+                for (int band = 0; band < numBands; ++band)
+                {
+                    if (band > 0)
+                        juce::FloatVectorOperations::max(loudestBand, loudestBand, envelopes[band], blockLength);
+
+                    bandBlockPeaks[static_cast<size_t>(band)] = juce::jmax(bandBlockPeaks[static_cast<size_t>(band)],
+                        static_cast<float>(juce::FloatVectorOperations::findMaximum(envelopes[band], blockLength)));
+                }
             }
 
-            // Update peak detector
-            if (envelopeToUse > state.peakHold)
+            updatePeakAndMeters(set, loudestBand, blockLength, meters);
+        }
+
+        // Stage 4: output. Each band is modulated by its own envelope and the
+        // bands are summed, which gives back the (allpassed) input at mix = 0.
+        // The lookahead holds the bands back rather than the dry input
+        const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::outputStage);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* channelData = mainBuffer.getWritePointer(channel, start);
+            const int set = channel % numEnvelopeSets;
+            captureEnvelope(channel, start, loudestBands[set], blockLength);
+
+            if constexpr (mode == sidechainMode)  // Sidechain mode: output ONLY the envelope
             {
-                state.peakHold = envelopeToUse;
+                juce::FloatVectorOperations::multiply(channelData, loudestBands[set], 0.707f * gain, blockLength);  // -3dB scaling
             }
             else
             {
-                state.peakHold *= state.peakReleaseCoeff;
+                auto* const* envelopes = bandEnvelopes + firstEnvelopeRow(set);
+
+                juce::FloatVectorOperations::clear(channelData, blockLength);
+                for (int band = 0; band < numBands; ++band)
+                {
+                    const int row = channel * maxBands + band;
+                    SampleType* bandSignal = bandSignals[row];
+                    if (lookahead)
+                        delaySignal(dsp.bandDelay, row, bandSignal, blockLength);
+
+                    const SampleType* bandEnvelope = envelopes[band];
+                    for (int j = 0; j < blockLength; ++j)
+                        channelData[j] += bandSignal[j] * ((1.0f - mix) + mix * bandEnvelope[j]);
+                }
+
+                // Drive into the saturation stage, as in createOutput
+                juce::FloatVectorOperations::multiply(channelData, gain * 0.5f, blockLength);
             }
+        }
 
-            // Track block peak for display
-            if (envelopeToUse > blockPeak)
-                blockPeak = envelopeToUse;
+        applySaturation(mainBuffer, start, blockLength, mode == sidechainMode ? 1 : Saturation::getNumStages(saturation), saturation);
+    }
+}
 
-            // Sum for overall display (average across channels)
-            overallEnvelopeSum += envelopeToUse;
+template <typename SampleType>
+void HilbertEnvelopeProcessor::updatePeakAndMeters(int stateIndex, const SampleType* envelope, int numSamples, BlockMeters& meters)
+{
+    auto& state = channelStates[static_cast<size_t>(stateIndex)];
 
-            // Create output based on mode
-            float output;
-            if (mode == 2)  // Sidechain mode: output ONLY the envelope
-            {
-                output = envelopeToUse * 0.707f * gain;  // -3dB scaling
-            }
-            else  // Instant or Smoothed mode: modulate the dry signal
-            {
-                output = createOutput(input, envelopeToUse, mix, gain);
-            }
+    // Peak hold, meters and scope are display data and stay in float
+    {
+        const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::peakStage);
+
+        for (int j = 0; j < numSamples; ++j)
+        {
+            const float envelopeToUse = static_cast<float>(envelope[j]);
+
+            // Update peak detector: hold the window maximum, then release
+            state.peakHold = juce::jmax(state.peakWindow.pushSample(envelopeToUse),
+                                        state.peakHold * peakReleaseCoeff);
+            peakHoldScratch[static_cast<size_t>(j)] = state.peakHold;
+
+            // Track block peak for display, sum for overall display (average across channels)
+            meters.peak = juce::jmax(meters.peak, envelopeToUse);
+            meters.sum += envelopeToUse;
+        }
+    }
+
+    // Feed the scope (it decimates into min/max frames itself) and the
+    // control-rate output, in a pass of their own so they time separately
+    if (stateIndex == 0)  // Only left channel for scope
+    {
+        const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::scopePushStage);
+
+        for (int j = 0; j < numSamples; ++j)
+        {
+            const float envelopeToUse = static_cast<float>(envelope[j]);
+            scopeFifo.pushSample(envelopeToUse, peakHoldScratch[static_cast<size_t>(j)]);
+            controlOutput.pushSample(envelopeToUse);
+        }
+    }
+
+    meters.numValues += numSamples;
+}
 
-            // Apply final soft clipping
-            output = std::tanh(output);
+template <typename SampleType>
+void HilbertEnvelopeProcessor::captureEnvelope(int channel, int start, const SampleType* envelope, int numSamples)
+{
+    if (envelopeCapture == nullptr)
+        return;
 
-            channelData[i] = output;
+    float* destination = envelopeCapture->getWritePointer(channel, start);
 
-            // Push samples to scope (every 10 samples for CPU)
-            if (i % 10 == 0 && channel == 0)  // Only left channel for scope
+    if constexpr (std::is_same_v<SampleType, float>)
+    {
+        juce::FloatVectorOperations::copy(destination, envelope, numSamples);
+    }
+    else
+    {
+        for (int i = 0; i < numSamples; ++i)
+            destination[i] = static_cast<float>(envelope[i]);
+    }
+}
+
+template <typename SampleType>
+void HilbertEnvelopeProcessor::applySaturation(juce::AudioBuffer<SampleType>& mainBuffer, int start, int numSamples,
+    int numStages, int saturation)
+{
+    // With output oversampling the clipping runs at the higher rate
+    juce::dsp::AudioBlock<SampleType> outputBlock(mainBuffer.getArrayOfWritePointers(), static_cast<size_t>(mainBuffer.getNumChannels()),
+                                             static_cast<size_t>(start), static_cast<size_t>(numSamples));
+    auto& dsp = getDsp<SampleType>();
+    auto& outputOversampler = *dsp.outputOversamplers[static_cast<size_t>(juce::jmax(0, activeOversampling - 1))];
+    auto clipBlock = activeOutputOversampling ? outputOversampler.processSamplesUp(outputBlock) : outputBlock;
+    const int clipLength = static_cast<int>(clipBlock.getNumSamples());
+
+    for (size_t channel = 0; channel < clipBlock.getNumChannels(); ++channel)
+        for (int stage = 0; stage < numStages; ++stage)
+        {
+            if (saturation == Saturation::reference)
+                Saturation::processBlock(clipBlock.getChannelPointer(channel), clipLength, true);
+            else
+                dsp.fastTanhKernel(clipBlock.getChannelPointer(channel), clipLength);
+        }
+
+    if (activeOutputOversampling)
+        outputOversampler.processSamplesDown(outputBlock);
+}
+
+template <typename SampleType>
+void HilbertEnvelopeProcessor::computeDetectorPower(const SampleType* const* inputs, int numInputs, int numSamples)
+{
+    auto& dsp = getDsp<SampleType>();
+    auto* const* powers = dsp.envelopeScratch.getArrayOfWritePointers();
+
+    if (activeOversampling == 0)
+    {
+        for (int channel = 0; channel < numInputs; ++channel)
+        {
+            activeBackend->process(channel, inputs[channel], dsp.realScratch.data(), dsp.hilbertScratch.data(), numSamples);
+            if (channel == 0)
             {
-                pushScopeSample(envelopeToUse, state.peakHold);
+                const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::analysisStage);
+                envelopeAnalyzer.process(dsp.realScratch.data(), dsp.hilbertScratch.data(), numSamples, 1);
             }
+            computePower(powers[channel], numSamples);
+        }
+        return;
+    }
 
-            // Advance delay line
-            bufferIndex = (bufferIndex + 1) % filterTaps;
+    // Run the Hilbert transform at the oversampled rate, where the top of the
+    // audio band is far from its Nyquist edge (updateHilbertEngine() scaled
+    // the backend so its low edge hasn't moved), and bring the power back
+    // down. |a|^2 is band limited (unlike |a|), so the half-band filters pass it cleanly
+    auto& oversampler = *dsp.detectorOversamplers[activeOversampling - 1];
+    auto upsampled = oversampler.processSamplesUp(juce::dsp::AudioBlock<const SampleType>(inputs,
+        static_cast<size_t>(numInputs), static_cast<size_t>(numSamples)));
+    const int numUpsampled = static_cast<int>(upsampled.getNumSamples());
+
+    for (int channel = 0; channel < numInputs; ++channel)
+    {
+        SampleType* data = upsampled.getChannelPointer(static_cast<size_t>(channel));
+        activeBackend->process(channel, data, dsp.realScratch.data(), dsp.hilbertScratch.data(), numUpsampled);
+        if (channel == 0)
+        {
+            const StageProfiler::ScopedTimer timer(stageProfiler, StageProfiler::analysisStage);
+            envelopeAnalyzer.process(dsp.realScratch.data(), dsp.hilbertScratch.data(), numUpsampled,
+                                     static_cast<int>(oversampler.getOversamplingFactor()));
+        }
+        computePower(data, numUpsampled);
+    }
+
+    juce::dsp::AudioBlock<SampleType> output(powers, static_cast<size_t>(numInputs), static_cast<size_t>(numSamples));
+    oversampler.processSamplesDown(output);
+
+    // The decimation filter rings slightly below zero on transients
+    for (int channel = 0; channel < numInputs; ++channel)
+        juce::FloatVectorOperations::max(powers[channel], powers[channel], static_cast<SampleType>(0), numSamples);
+}
+
+template <typename SampleType>
+void HilbertEnvelopeProcessor::computePower(SampleType* destination, int numSamples)
+{
+    const auto& real = getDsp<SampleType>().realScratch;
+    const auto& imag = getDsp<SampleType>().hilbertScratch;
+
+    for (int i = 0; i < numSamples; ++i)
+        destination[i] = real[i] * real[i] + imag[i] * imag[i];
+}
+
+void HilbertEnvelopeProcessor::emitControlOutput(juce::MidiBuffer& midiMessages)
+{
+    const int numEvents = controlOutput.getNumEvents();
+    if (numEvents == 0)
+        return;
+
+    // The parameter only needs the latest value, which timerCallback hands to the host
+    envelopeOutValue.store(static_cast<float>(controlOutput.getLastValue()) / 127.0f);
+
+    if (midiOutputParam->load() < 0.5f)
+        return;
+
+    // At most maxMidiOutputBytes, which the caller has reserved
+    const int midiChannel = static_cast<int>(midiChannelParam->load());
+    const int controller = static_cast<int>(midiCcParam->load());
+    for (int i = 0; i < numEvents; ++i)
+    {
+        const auto& event = controlOutput.getEvent(i);
+        midiMessages.addEvent(juce::MidiMessage::controllerEvent(midiChannel, controller, event.value), event.sampleOffset);
+    }
+}
+
+void HilbertEnvelopeProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) HILBERT_NONBLOCKING
+{
+    processSamples(buffer, midiMessages);
+}
+
+void HilbertEnvelopeProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages) HILBERT_NONBLOCKING
+{
+    processSamples(buffer, midiMessages);
+}
+
+template <typename SampleType>
+void HilbertEnvelopeProcessor::processSamples(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    // Debug builds of the tools assert on any allocation from here on (see RealtimeGuard.h)
+    const RealtimeGuard realtimeGuard;
+    stageProfiler.beginBlock();
+
+    // A host switching precision without preparing again: the other state
+    // was prepared too, but holds whatever it had when it was last used
+    if (std::is_same_v<SampleType, double> != processingDouble)
+    {
+        processingDouble = std::is_same_v<SampleType, double>;
+        resetDsp<SampleType>();
+    }
+
+    auto totalNumInputChannels = getMainBusNumInputChannels();
+    auto totalNumOutputChannels = getTotalNumOutputChannels();
+
+    // Clear any output channels that don't contain input data
+    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+        buffer.clear(i, 0, buffer.getNumSamples());
+
+    // Views into the host buffer (no copies): the main bus, and the sidechain
+    // key when the host has it connected
+    auto mainBuffer = getBusBuffer(buffer, true, 0);
+    const auto keyBuffer = getBusCount(true) > 1 ? getBusBuffer(buffer, true, 1)
+                                                 : juce::AudioBuffer<SampleType>();
+
+    const float mix = mixParam->load();
+    const float gain = gainParam->load();
+    const int mode = static_cast<int>(modeParam->load());
+    const int saturation = static_cast<int>(saturationParam->load());
+    const int link = static_cast<int>(linkParam->load());
+    const int numBands = static_cast<int>(bandsParam->load());
+
+    // The band-split front end covers the unkeyed modes; a connected key in
+    // Sidechain mode always uses the broadband detector
+    const bool keyed = mode == sidechainMode && keyBuffer.getNumChannels() > 0;
+    jassert(mainBuffer.getNumChannels() <= maxSupportedChannels && keyBuffer.getNumChannels() <= maxSupportedChannels);
+    const bool bandSplit = numBands > 1 && !keyed;
+    keyInputActive.store(keyed);
+
+    // Pick up engine / kernel length / band-split changes
+    updateHilbertEngine<SampleType>(bandSplit);
+    if (bandSplit)
+        getDsp<SampleType>().bandSplitBank.setNumBands(numBands);
+
+    // Retarget the coefficient ramps if attack/release moved
+    updateSmoothingCoefficients();
+
+    const int holdSamples = juce::roundToInt(holdParam->load() * 0.001 * sampleRate);
+    for (auto& state : channelStates)
+        state.peakWindow.setHoldSamples(holdSamples);
+
+    // Track overall peak and average for display
+    BlockMeters meters;
+    controlOutput.beginBlock(controlRateParam->load(), static_cast<int>(controlThresholdParam->load()));
+    bandBlockPeaks.fill(0.0f);
+
+    if (bandSplit)
+    {
+        switch (mode)
+        {
+        case smoothedMode:  processBands<smoothedMode>(mainBuffer, mix, gain, saturation, link, meters); break;
+        case sidechainMode: processBands<sidechainMode>(mainBuffer, mix, gain, saturation, link, meters); break;
+        default:            processBands<instantMode>(mainBuffer, mix, gain, saturation, link, meters); break;
+        }
+    }
+    else
+    {
+        switch (mode)
+        {
+        case smoothedMode:
+            processChannels<smoothedMode>(mainBuffer, keyBuffer, mix, gain, saturation, link, meters);
+            break;
+        case sidechainMode:
+            if (keyed)
+                processChannels<keyedSidechainMode>(mainBuffer, keyBuffer, mix, gain, saturation, link, meters);
+            else
+                processChannels<sidechainMode>(mainBuffer, keyBuffer, mix, gain, saturation, link, meters);
+            break;
+        default:
+            processChannels<instantMode>(mainBuffer, keyBuffer, mix, gain, saturation, link, meters);
+            break;
         }
     }
 
     // Update atomic variables for GUI
-    if (totalNumInputChannels > 0)
+    if (meters.numValues > 0)
     {
-        float averageEnvelope = overallEnvelopeSum / (totalNumInputChannels * numSamples);
+        float averageEnvelope = meters.sum / static_cast<float>(meters.numValues);
         currentEnvelope.store(averageEnvelope);
     }
     else
@@ -242,7 +955,15 @@ void HilbertEnvelopeProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
     }
 
     // Update peak envelope
-    peakEnvelope.store(blockPeak);
+    peakEnvelope.store(meters.peak);
+
+    for (size_t band = 0; band < bandEnvelopes.size(); ++band)
+        bandEnvelopes[band].store(bandBlockPeaks[band]);
+
+    // Thinned control-rate output: parameter and MIDI CCs
+    emitControlOutput(midiMessages);
+
+    stageProfiler.endBlock(buffer.getNumSamples());
 }
 
 juce::AudioProcessorEditor* HilbertEnvelopeProcessor::createEditor()
@@ -250,9 +971,17 @@ juce::AudioProcessorEditor* HilbertEnvelopeProcessor::createEditor()
     return new HilbertEnvelopeEditor(*this);
 }
 
+// envelopeOut is an output rather than a setting: it is left out of saved
+// state, and ignored in sessions saved before it was
+static void removeOutputParameters(juce::ValueTree& state)
+{
+    state.removeChild(state.getChildWithProperty("id", "envelopeOut"), nullptr);
+}
+
 void HilbertEnvelopeProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
     auto state = parameters.copyState();
+    removeOutputParameters(state);
     std::unique_ptr<juce::XmlElement> xml(state.createXml());
     copyXmlToBinary(*xml, destData);
 }
@@ -261,7 +990,11 @@ void HilbertEnvelopeProcessor::setStateInformation(const void* data, int sizeInB
 {
     std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
     if (xmlState.get() != nullptr && xmlState->hasTagName(parameters.state.getType()))
-        parameters.replaceState(juce::ValueTree::fromXml(*xmlState));
+    {
+        auto state = juce::ValueTree::fromXml(*xmlState);
+        removeOutputParameters(state);
+        parameters.replaceState(state);
+    }
 }
 
 // Factory function
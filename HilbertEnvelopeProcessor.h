@@ -2,8 +2,22 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "FixedHilbertFir.h"
+#include "HilbertFftConvolver.h"
+#include "HilbertIirAllpass.h"
+#include "ScopeFifo.h"
+#include "Saturation.h"
+#include "EnvelopeFollower.h"
+#include "TimeConstantTable.h"
+#include "SlidingPeakHold.h"
+#include "BandSplitBank.h"
+#include "ControlRateOutput.h"
+#include "RealtimeGuard.h"
+#include "StageProfiler.h"
+#include "EnvelopeAnalyzer.h"
 
-class HilbertEnvelopeProcessor : public juce::AudioProcessor
+class HilbertEnvelopeProcessor : public juce::AudioProcessor,
+                                  private juce::Timer
 {
 public:
     HilbertEnvelopeProcessor();
@@ -13,15 +27,27 @@ public:
     // Required JUCE AudioProcessor overrides
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
-    void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) HILBERT_NONBLOCKING override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) HILBERT_NONBLOCKING override;
+
+    // The whole DSP path is templated on the sample type, so 64-bit hosts
+    // don't need to convert around the plugin
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override { return true; }
 
     const juce::String getName() const override { return "Hilbert Envelope"; }
 
-    bool acceptsMidi() const override { return false; }
-    bool producesMidi() const override { return false; }
+    // Incoming MIDI passes through; the envelope can be sent out as a CC stream
+    bool acceptsMidi() const override { return true; }
+    bool producesMidi() const override { return true; }
+
+    // Most MIDI storage one processBlock adds when CC output is on. The
+    // MidiBuffer passed in must already have room for this on top of its own
+    // events (MidiBuffer::ensureSize), or adding the CCs allocates on the
+    // audio thread. Plugin wrappers reserve their buffers; offline callers must too.
+    static constexpr int maxMidiOutputBytes = ControlRateOutput::maxMidiBytesPerBlock;
     double getTailLengthSeconds() const override { return 0.0; }
 
     int getNumPrograms() override { return 1; }
@@ -33,12 +59,30 @@ public:
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
+    // Every channel has its own detector state, so any matching layout up to
+    // maxSupportedChannels works (mono, stereo, 5.1, 7.1.4, 3rd order ambisonic...)
+    static constexpr int maxSupportedChannels = 16;
+    static constexpr int maxBands = BandSplitBank<float>::maxBands;
+
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override
     {
         if (layouts.getMainInputChannelSet() == juce::AudioChannelSet::disabled()
             || layouts.getMainOutputChannelSet() == juce::AudioChannelSet::disabled())
             return false;
 
+        if (layouts.getMainInputChannelSet().size() > maxSupportedChannels)
+            return false;
+
+        // The sidechain key may be disabled, mono or stereo
+        if (layouts.inputBuses.size() > 1)
+        {
+            const auto keySet = layouts.getChannelSet(true, 1);
+            if (keySet != juce::AudioChannelSet::disabled()
+                && keySet != juce::AudioChannelSet::mono()
+                && keySet != juce::AudioChannelSet::stereo())
+                return false;
+        }
+
         return layouts.getMainInputChannelSet() == layouts.getMainOutputChannelSet();
     }
 
@@ -48,51 +92,211 @@ public:
     float getPeakEnvelope() const { return peakEnvelope.load(); }
     void resetPeak() { peakEnvelope = 0.0f; }
 
-    // For scope visualization
-    void pushScopeSample(float env, float peak);
+    // True while Sidechain mode is detecting from a connected key input
+    bool isKeyInputActive() const { return keyInputActive.load(); }
+
+    // Per-band envelope peaks of the last block ("bands" > 1), for analysis
+    // displays; 0 for bands that aren't in use
+    float getBandEnvelope(int band) const { return bandEnvelopes[static_cast<size_t>(band)].load(); }
+
+    // For scope visualization: the editor drains this every vblank
+    ScopeFifo& getScopeFifo() { return scopeFifo; }
+
+    // Per-stage processBlock timings, published every few seconds of audio
+    StageProfiler& getStageProfiler() { return stageProfiler; }
+
+    // Onsets, short-term RMS, crest factor and instantaneous frequency of the
+    // detector signal. One consumer only: the editor, or an offline renderer
+    EnvelopeAnalyzer& getEnvelopeAnalyzer() { return envelopeAnalyzer; }
+
+    // Offline use only: when set, processBlock also writes the detector
+    // envelope of every channel here. The buffer must have at least as many
+    // channels and samples as the blocks being processed.
+    void setEnvelopeCapture(juce::AudioBuffer<float>* destination) { envelopeCapture = destination; }
+
+    // Delay of the captured envelope behind the input. Only the detector
+    // delays it: unlike getLatencySamples() it excludes the lookahead and the
+    // output oversampler, which only delay the audio
+    int getEnvelopeLatencySamples() const { return envelopeLatency; }
 
     juce::AudioProcessorValueTreeState& getValueTreeState() { return parameters; }
 
 private:
+    // Host notifications for what the audio thread published, on the message thread
+    void timerCallback() override;
+
     // Audio processing
-    void initializeHilbertFilter();
     void updateSmoothingCoefficients();
+    void fillCoefficientRamps(int numSamples);
+    template <typename SampleType>
+    void prepareDsp(int numChannels);
+    template <typename SampleType>
+    void resetDsp();
+    template <typename SampleType>
+    void updateHilbertEngine(bool bandSplit);
+    HilbertBackend& getBackend(int engine, int quality, int oversampling);
+    template <typename SampleType>
+    using SampleDelay = juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None>;
+    template <typename SampleType>
+    static void delaySignal(SampleDelay<SampleType>& delay, int channel, SampleType* data, int numSamples);
+    template <typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages);
 
-    // Smoothing filter for envelope
-    float processEnvelopeSmoothing(float input, float currentState,
-        float attackCoeff, float releaseCoeff);
+    // Detector and output stages for every channel, compiled once per mode so
+    // the sample loops don't re-check it
+    // keyedSidechainMode is Sidechain with an active key bus: the detector runs on
+    // the key and ducks the main signal
+    enum Mode { instantMode = 0, smoothedMode, sidechainMode, keyedSidechainMode };
+    enum ChannelLink { linkOff = 0, linkMax, linkRms, linkMid };
+    struct BlockMeters
+    {
+        float peak = 0.0f;
+        float sum = 0.0f;
+        int numValues = 0;
+    };
+    template <int mode, typename SampleType>
+    void processChannels(juce::AudioBuffer<SampleType>& mainBuffer, const juce::AudioBuffer<SampleType>& keyBuffer,
+        float mix, float gain, int saturation, int link, BlockMeters& meters);
+    template <int mode, typename SampleType>
+    void processBands(juce::AudioBuffer<SampleType>& mainBuffer, float mix, float gain, int saturation, int link,
+        BlockMeters& meters);
+    template <typename SampleType>
+    void updatePeakAndMeters(int stateIndex, const SampleType* envelope, int numSamples, BlockMeters& meters);
+    template <typename SampleType>
+    void captureEnvelope(int channel, int start, const SampleType* envelope, int numSamples);
+    template <typename SampleType>
+    void applySaturation(juce::AudioBuffer<SampleType>& mainBuffer, int start, int numSamples, int numStages, int saturation);
+    template <typename SampleType>
+    void computeDetectorPower(const SampleType* const* inputs, int numInputs, int numSamples);
+    template <typename SampleType>
+    void computePower(SampleType* destination, int numSamples);  // |analytic|^2 from the scratch buffers
+    template <typename SampleType>
+    int getDetectorLatency();
+    void emitControlOutput(juce::MidiBuffer& midiMessages);
 
     // Output creation with proper mixing
-    float createOutput(float input, float envelope, float mix, float gain);
+    template <typename SampleType>
+    SampleType createOutput(SampleType input, SampleType envelope, float mix, float gain);
+    template <typename SampleType>
+    SampleType createDuckedOutput(SampleType input, SampleType keyEnvelope, float mix, float gain);
+
+    // Hilbert transform backends, selected by the "engine" parameter. The
+    // Standard engine has one kernel per "quality" tap count, and steps up a
+    // length per doubling of the rate when the detector is oversampled
+    enum HilbertEngine { standardEngine = 0, highPrecisionEngine, lowLatencyEngine };
+    enum FirQuality { taps15 = 0, taps31, taps63, taps127, taps255, taps511, taps1023 };
+    FixedHilbertFir<15> hilbertFir15;
+    FixedHilbertFir<31> hilbertFir31;
+    FixedHilbertFir<63> hilbertFir63;
+    FixedHilbertFir<127> hilbertFir127;
+    FixedHilbertFir<255> hilbertFir255;
+    FixedHilbertFir<511> hilbertFir511;
+    FixedHilbertFir<1023> hilbertFir1023;
+    HilbertFftConvolver hilbertFft;
+    HilbertIirAllpass hilbertIir;
+    HilbertBackend* activeBackend = &hilbertFir31;
+    int activeEngine = standardEngine;
+    int activeQuality = taps31;
 
-    // Hilbert transform
-    std::vector<float> hilbertBuffer;
-    int bufferIndex = 0;
-    std::vector<float> hilbertCoeffs;
-    int filterTaps = 31;  // FIXED: Should be 31, not 32
+    int maxBlockSize = 512;
+
+    // Optional 2x/4x/8x oversampling (index = order - 1) around the detector,
+    // and separately around the output saturation
+    static constexpr int maxOversamplingFactor = 8;
+    int activeOversampling = 0;
+    bool activeOutputOversampling = false;
+
+    // The dry signal is delayed by the detector latency plus the lookahead
+    static constexpr float maxLookaheadMs = 20.0f;
+
+    // Everything that holds samples, once per precision. Both are prepared,
+    // so a host may switch precision without preparing again; the state that
+    // takes over starts from silence (see resetDsp)
+    template <typename SampleType>
+    struct DspState
+    {
+        std::vector<SampleType> realScratch;
+        std::vector<SampleType> hilbertScratch;
+        std::vector<SampleType> detectorScratch;  // channel average for the "Mid" link
+        juce::AudioBuffer<SampleType> envelopeScratch;  // one chunk of detector envelope per channel
+
+        std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, 3> detectorOversamplers;
+        std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, 3> outputOversamplers;
+        SampleDelay<SampleType> dryDelay;
+
+        // Attack/release smoothing for the Smoothed and Sidechain modes
+        EnvelopeFollower<SampleType> envelopeFollower;
+
+        // Band-split front end, with one follower state per band of every channel.
+        // The scratch has maxBands rows per channel plus a set for the "Mid"
+        // link's split of the channel average, and bandDelay holds every
+        // channel's bands back by the lookahead
+        BandSplitBank<SampleType> bandSplitBank;
+        EnvelopeFollower<SampleType> bandFollower;
+        juce::AudioBuffer<SampleType> bandSignalScratch;
+        juce::AudioBuffer<SampleType> bandEnvelopeScratch;
+        SampleDelay<SampleType> bandDelay;
+
+        // Fast saturation loop for this CPU
+        Saturation::BlockKernel<SampleType> fastTanhKernel = Saturation::fastTanhBaseline<SampleType>;
+    };
+    DspState<float> floatDsp;
+    DspState<double> doubleDsp;
+    bool processingDouble = false;
+
+    template <typename SampleType>
+    DspState<SampleType>& getDsp()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleDsp;
+        else
+            return floatDsp;
+    }
 
     // Envelope tracking
     std::atomic<float> currentEnvelope{ 0.0f };
     std::atomic<float> peakEnvelope{ 0.0f };
+    std::atomic<bool> keyInputActive{ false };
+    std::array<std::atomic<float>, maxBands> bandEnvelopes{};
 
-    // For scope visualization
-    std::atomic<float> scopeCurrentEnvelope{ 0.0f };
-    std::atomic<float> scopePeakEnvelope{ 0.0f };
+    // For scope visualization (written by the audio thread only)
+    ScopeFifo scopeFifo;
+    EnvelopeAnalyzer envelopeAnalyzer;
 
-    // Per-channel smoothing states
+    juce::AudioBuffer<float>* envelopeCapture = nullptr;
+    int envelopeLatency = 0;
+
+    // Band-split meters
+    std::array<float, maxBands> bandBlockPeaks{};
+    bool activeBandSplit = false;
+
+    // Decimated copy of the scope envelope for the "envelopeOut" parameter and
+    // the MIDI CC stream
+    ControlRateOutput controlOutput;
+
+    // Peak detector state per envelope (one when the channels are linked)
+    static constexpr float maxHoldMs = 5000.0f;
     struct ChannelState
     {
-        float smoothedEnvelope = 0.0f;
         float peakHold = 0.0f;
-        float peakReleaseCoeff = 0.999f;
+        SlidingPeakHold peakWindow;
     };
     std::vector<ChannelState> channelStates;
+    std::vector<float> peakHoldScratch;  // the first envelope's peak hold, for the scope
+
+    // Audio thread timing, read by the editor
+    StageProfiler stageProfiler;
 
-    // Smoothing coefficients
-    float currentAttackCoeff = 0.0f;
-    float currentReleaseCoeff = 0.0f;
-    float targetAttackCoeff = 0.0f;
-    float targetReleaseCoeff = 0.0f;
+    // Smoothing coefficients: looked up only when the parameters change, then
+    // ramped per sample so the result doesn't depend on the host block size
+    TimeConstantTable timeConstants;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> attackCoeffRamp;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> releaseCoeffRamp;
+    std::vector<float> attackCoeffScratch;
+    std::vector<float> releaseCoeffScratch;
+    float peakReleaseCoeff = 0.999f;
+    float lastAttackMs = -1.0f;
+    float lastReleaseMs = -1.0f;
 
     // Parameters
     juce::AudioProcessorValueTreeState parameters;
@@ -101,6 +305,24 @@ private:
     std::atomic<float>* attackParam = nullptr;
     std::atomic<float>* releaseParam = nullptr;
     std::atomic<float>* modeParam = nullptr;
+    std::atomic<float>* engineParam = nullptr;
+    std::atomic<float>* precisionParam = nullptr;
+    std::atomic<float>* qualityParam = nullptr;
+    std::atomic<float>* saturationParam = nullptr;
+    std::atomic<float>* linkParam = nullptr;
+    std::atomic<float>* oversamplingParam = nullptr;
+    std::atomic<float>* oversampleOutputParam = nullptr;
+    std::atomic<float>* lookaheadParam = nullptr;
+    std::atomic<float>* holdParam = nullptr;
+    std::atomic<float>* bandsParam = nullptr;
+    std::atomic<float>* controlRateParam = nullptr;
+    std::atomic<float>* controlThresholdParam = nullptr;
+    std::atomic<float>* midiOutputParam = nullptr;
+    std::atomic<float>* midiCcParam = nullptr;
+    std::atomic<float>* midiChannelParam = nullptr;
+    juce::AudioParameterFloat* envelopeOutParam = nullptr;  // set from timerCallback
+    std::atomic<float> envelopeOutValue{ 0.0f };            // the audio thread's latest value for it
+    std::atomic<int> pendingLatency{ 0 };                   // for setLatencySamples, from timerCallback
 
     double sampleRate = 44100.0;
 
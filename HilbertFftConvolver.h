@@ -0,0 +1,381 @@
+// HilbertFftConvolver.h
+#pragma once
+#include <JuceHeader.h>
+#include "HilbertBackend.h"
+#include "HilbertKernelDesign.h"
+
+//==============================================================================
+// High precision Hilbert engine
+//
+// Runs long (255-2047 tap) windowed Hilbert kernels with uniformly partitioned
+// overlap-save FFT convolution. An oversampled detector steps up one length
+// per doubling of the rate (to at most 16383 taps at 8x), which keeps the low
+// band edge in Hz. The kernel is cut into partitions of
+// partitionSize samples whose spectra are computed once in prepare(); every
+// partitionSize input samples one forward FFT, one complex multiply-accumulate
+// per partition and one inverse FFT produce the next block of output. The
+// cost per sample is dominated by the two FFTs, so it stays roughly flat as
+// the kernel gets longer.
+//
+// The imaginary (Hilbert) output lags the input by partitionSize samples of
+// buffering plus the kernel's centre delay; the real output is the input
+// delayed by the same amount so the two form an analytic pair. Each precision
+// has its own state and kernel spectra; juce::dsp::FFT is single precision
+// only, so double blocks use a plain radix-2 transform of the same size.
+//==============================================================================
+class HilbertFftConvolver : public HilbertBackend
+{
+public:
+    static constexpr int partitionOrder = 8;
+    static constexpr int partitionSize = 1 << partitionOrder;
+    static constexpr int numKernelLengths = 7;
+    static constexpr int maxKernelLength = (256 << (numKernelLengths - 1)) - 1;
+
+    // The "precision" choices, i.e. the first four lengths
+    static const juce::StringArray& getKernelLengthNames()
+    {
+        static const juce::StringArray names{ "255", "511", "1023", "2047" };
+        return names;
+    }
+
+    static int getKernelLength(int index)
+    {
+        return (256 << juce::jlimit(0, numKernelLengths - 1, index)) - 1;
+    }
+
+    HilbertFftConvolver() : fft(partitionOrder + 1), doubleFft(partitionOrder + 1) {}
+
+    void prepare(int numChannels, int maxBlockSize) override
+    {
+        juce::ignoreUnused(maxBlockSize);
+        preparePrecision(floatState, numChannels);
+        preparePrecision(doubleState, numChannels);
+        reset();
+    }
+
+    void reset() override
+    {
+        resetPrecision(floatState);
+        resetPrecision(doubleState);
+    }
+
+    // Selects getKernelLength(index): a precision choice plus one step per
+    // doubling of the rate. Clears the convolution state on a change
+    void setKernelLengthIndex(int index)
+    {
+        index = juce::jlimit(0, numKernelLengths - 1, index);
+        if (index == kernelIndex)
+            return;
+
+        kernelIndex = index;
+        reset();
+    }
+
+    int getLatencySamples() const override
+    {
+        return partitionSize + getKernelLength(kernelIndex) / 2;
+    }
+
+    // At the base rate. The longer kernels only run oversampled, where their
+    // latency in base rate samples is no more than the longest choice's
+    static int getMaxLatencySamples()
+    {
+        return partitionSize + getKernelLength(getKernelLengthNames().size() - 1) / 2;
+    }
+
+    // Writes the delayed input to real and its Hilbert transform to imag
+    void process(int channel, const float* input, float* real, float* imag, int numSamples) override
+    {
+        processChannel(floatState, channel, input, real, imag, numSamples);
+    }
+
+    void process(int channel, const double* input, double* real, double* imag, int numSamples) override
+    {
+        processChannel(doubleState, channel, input, real, imag, numSamples);
+    }
+
+private:
+    static constexpr int fftSize = 2 * partitionSize;
+    static constexpr int numBins = partitionSize + 1;
+
+    //==============================================================================
+    // Iterative radix-2 complex FFT for the double blocks, with the same
+    // real-only layout as juce::dsp::FFT: the forward transform leaves bins
+    // 0..size/2 as interleaved complex values, the inverse reads them back and
+    // scales by 1/size
+    class DoubleFft
+    {
+    public:
+        explicit DoubleFft(int order)
+            : size(1 << order), buffer(static_cast<size_t>(size)), twiddles(static_cast<size_t>(size / 2)),
+              bitReversed(static_cast<size_t>(size))
+        {
+            for (int k = 0; k < size / 2; ++k)
+                twiddles[static_cast<size_t>(k)] = std::polar(1.0, -juce::MathConstants<double>::twoPi * k / size);
+
+            for (int i = 0; i < size; ++i)
+            {
+                int reversed = 0;
+                for (int bit = 0; bit < order; ++bit)
+                    reversed |= ((i >> bit) & 1) << (order - 1 - bit);
+                bitReversed[static_cast<size_t>(i)] = reversed;
+            }
+        }
+
+        void performRealOnlyForwardTransform(double* data)
+        {
+            for (int i = 0; i < size; ++i)
+                buffer[static_cast<size_t>(i)] = { data[i], 0.0 };
+
+            transform(false);
+            std::copy_n(buffer.data(), size / 2 + 1, reinterpret_cast<std::complex<double>*>(data));
+        }
+
+        void performRealOnlyInverseTransform(double* data)
+        {
+            const auto* bins = reinterpret_cast<const std::complex<double>*>(data);
+            for (int k = 0; k <= size / 2; ++k)
+                buffer[static_cast<size_t>(k)] = bins[k];
+            for (int k = size / 2 + 1; k < size; ++k)
+                buffer[static_cast<size_t>(k)] = std::conj(bins[size - k]);
+
+            transform(true);
+            for (int i = 0; i < size; ++i)
+                data[i] = buffer[static_cast<size_t>(i)].real() / size;
+        }
+
+    private:
+        void transform(bool inverse)
+        {
+            for (int i = 0; i < size; ++i)
+                if (i < bitReversed[static_cast<size_t>(i)])
+                    std::swap(buffer[static_cast<size_t>(i)], buffer[static_cast<size_t>(bitReversed[static_cast<size_t>(i)])]);
+
+            for (int length = 2; length <= size; length <<= 1)
+            {
+                const int half = length / 2;
+                const int step = size / length;
+
+                for (int start = 0; start < size; start += length)
+                    for (int k = 0; k < half; ++k)
+                    {
+                        const auto twiddle = twiddles[static_cast<size_t>(k * step)];
+                        const auto w = inverse ? std::conj(twiddle) : twiddle;
+                        auto& a = buffer[static_cast<size_t>(start + k)];
+                        auto& b = buffer[static_cast<size_t>(start + k + half)];
+                        const auto product = b * w;
+                        b = a - product;
+                        a += product;
+                    }
+            }
+        }
+
+        int size;
+        std::vector<std::complex<double>> buffer;
+        std::vector<std::complex<double>> twiddles;
+        std::vector<int> bitReversed;
+    };
+
+    //==============================================================================
+    template <typename SampleType>
+    struct ChannelState
+    {
+        std::vector<SampleType> frame;                 // last 2 * partitionSize input samples
+        std::vector<SampleType> output;                // Hilbert output for the current partition
+        std::vector<SampleType> delayedInput;          // real branch delay ring
+        std::vector<std::complex<SampleType>> spectra; // frequency domain delay line
+        int position = 0;
+        int spectrumIndex = 0;
+        int delayIndex = 0;
+    };
+
+    // Everything one precision convolves with
+    template <typename SampleType>
+    struct PrecisionState
+    {
+        std::vector<std::vector<std::complex<SampleType>>> kernelSpectra;
+        std::vector<ChannelState<SampleType>> channels;
+        std::vector<SampleType> fftBuffer;
+        std::vector<std::complex<SampleType>> accumulator;
+    };
+
+    static int numPartitionsFor(int kernelLength)
+    {
+        return (kernelLength + partitionSize - 1) / partitionSize;
+    }
+
+    void forwardTransform(float* data) { fft.performRealOnlyForwardTransform(data, true); }
+    void forwardTransform(double* data) { doubleFft.performRealOnlyForwardTransform(data); }
+    void inverseTransform(float* data) { fft.performRealOnlyInverseTransform(data); }
+    void inverseTransform(double* data) { doubleFft.performRealOnlyInverseTransform(data); }
+
+    template <typename SampleType>
+    void preparePrecision(PrecisionState<SampleType>& precision, int numChannels)
+    {
+        // Spectra for every kernel length are kept so switching never allocates
+        precision.kernelSpectra.clear();
+        for (int i = 0; i < numKernelLengths; ++i)
+            precision.kernelSpectra.push_back(computeKernelSpectra<SampleType>(getKernelLength(i)));
+
+        const int maxPartitions = numPartitionsFor(maxKernelLength);
+
+        precision.channels.resize(static_cast<size_t>(juce::jmax(1, numChannels)));
+        for (auto& state : precision.channels)
+        {
+            state.frame.assign(2 * partitionSize, 0);
+            state.output.assign(partitionSize, 0);
+            state.delayedInput.assign(partitionSize + maxKernelLength, 0);
+            state.spectra.assign(static_cast<size_t>(maxPartitions * numBins), {});
+        }
+
+        precision.fftBuffer.assign(4 * partitionSize, 0);
+        precision.accumulator.assign(numBins, {});
+    }
+
+    template <typename SampleType>
+    static void resetPrecision(PrecisionState<SampleType>& precision)
+    {
+        for (auto& state : precision.channels)
+        {
+            std::fill(state.frame.begin(), state.frame.end(), SampleType());
+            std::fill(state.output.begin(), state.output.end(), SampleType());
+            std::fill(state.delayedInput.begin(), state.delayedInput.end(), SampleType());
+            std::fill(state.spectra.begin(), state.spectra.end(), std::complex<SampleType>{});
+            state.position = 0;
+            state.spectrumIndex = 0;
+            state.delayIndex = 0;
+        }
+    }
+
+    // The Standard engine's windowed ideal Hilbert transformer (see
+    // HilbertKernelDesign.h), centred on length / 2
+    template <typename SampleType>
+    static std::vector<SampleType> designKernel(int length)
+    {
+        std::vector<SampleType> kernel(static_cast<size_t>(length), 0);
+        const int centre = length / 2;
+
+        for (int n = 0; n < length; ++n)
+        {
+            const int k = n - centre;
+            if ((k & 1) != 0)
+                kernel[static_cast<size_t>(n)] = static_cast<SampleType>(HilbertKernelDesign::tapGain(k, length));
+        }
+
+        return kernel;
+    }
+
+    template <typename SampleType>
+    std::vector<std::complex<SampleType>> computeKernelSpectra(int length)
+    {
+        const auto kernel = designKernel<SampleType>(length);
+        const int numPartitions = numPartitionsFor(length);
+        std::vector<std::complex<SampleType>> result(static_cast<size_t>(numPartitions * numBins));
+        std::vector<SampleType> buffer(2 * fftSize, 0);
+
+        for (int p = 0; p < numPartitions; ++p)
+        {
+            std::fill(buffer.begin(), buffer.end(), SampleType());
+            const int count = juce::jmin(partitionSize, length - p * partitionSize);
+            std::copy(kernel.begin() + p * partitionSize, kernel.begin() + p * partitionSize + count, buffer.begin());
+
+            forwardTransform(buffer.data());
+            std::copy_n(reinterpret_cast<const std::complex<SampleType>*>(buffer.data()), numBins, result.data() + p * numBins);
+        }
+
+        return result;
+    }
+
+    template <typename SampleType>
+    void processChannel(PrecisionState<SampleType>& precision, int channel,
+                        const SampleType* input, SampleType* real, SampleType* imag, int numSamples)
+    {
+        jassert(juce::isPositiveAndBelow(channel, static_cast<int>(precision.channels.size())));
+        auto& state = precision.channels[static_cast<size_t>(channel)];
+
+        processRealBranch(state, input, real, numSamples);
+        processHilbertBranch(precision, state, input, imag, numSamples);
+    }
+
+    template <typename SampleType>
+    void processRealBranch(ChannelState<SampleType>& state, const SampleType* input, SampleType* real, int numSamples)
+    {
+        const int delay = getLatencySamples();
+        const int size = static_cast<int>(state.delayedInput.size());
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            state.delayedInput[static_cast<size_t>(state.delayIndex)] = input[i];
+            int readIndex = state.delayIndex - delay;
+            if (readIndex < 0)
+                readIndex += size;
+
+            real[i] = state.delayedInput[static_cast<size_t>(readIndex)];
+
+            if (++state.delayIndex == size)
+                state.delayIndex = 0;
+        }
+    }
+
+    template <typename SampleType>
+    void processHilbertBranch(PrecisionState<SampleType>& precision, ChannelState<SampleType>& state,
+                              const SampleType* input, SampleType* imag, int numSamples)
+    {
+        for (int done = 0; done < numSamples;)
+        {
+            const int n = juce::jmin(partitionSize - state.position, numSamples - done);
+
+            std::memcpy(state.frame.data() + partitionSize + state.position, input + done, sizeof(SampleType) * static_cast<size_t>(n));
+            std::memcpy(imag + done, state.output.data() + state.position, sizeof(SampleType) * static_cast<size_t>(n));
+
+            state.position += n;
+            done += n;
+
+            if (state.position == partitionSize)
+                processPartition(precision, state);
+        }
+    }
+
+    template <typename SampleType>
+    void processPartition(PrecisionState<SampleType>& precision, ChannelState<SampleType>& state)
+    {
+        const auto& kernel = precision.kernelSpectra[static_cast<size_t>(kernelIndex)];
+        const int numPartitions = numPartitionsFor(getKernelLength(kernelIndex));
+        auto& fftBuffer = precision.fftBuffer;
+        auto& accumulator = precision.accumulator;
+
+        // Forward transform of the overlap-save frame into the delay line
+        std::fill(fftBuffer.begin(), fftBuffer.end(), SampleType());
+        std::copy(state.frame.begin(), state.frame.end(), fftBuffer.begin());
+        forwardTransform(fftBuffer.data());
+
+        state.spectrumIndex = (state.spectrumIndex + 1) % numPartitions;
+        std::copy_n(reinterpret_cast<const std::complex<SampleType>*>(fftBuffer.data()), numBins, state.spectra.data() + state.spectrumIndex * numBins);
+
+        // Multiply-accumulate every kernel partition with its delayed input spectrum
+        std::fill(accumulator.begin(), accumulator.end(), std::complex<SampleType>{});
+        for (int p = 0; p < numPartitions; ++p)
+        {
+            const int slot = (state.spectrumIndex - p + numPartitions) % numPartitions;
+            const auto* x = state.spectra.data() + slot * numBins;
+            const auto* h = kernel.data() + p * numBins;
+
+            for (int bin = 0; bin < numBins; ++bin)
+                accumulator[static_cast<size_t>(bin)] += x[bin] * h[bin];
+        }
+
+        std::copy(accumulator.begin(), accumulator.end(), reinterpret_cast<std::complex<SampleType>*>(fftBuffer.data()));
+        inverseTransform(fftBuffer.data());
+
+        // The second half of the frame is free of circular wrap-around
+        std::memcpy(state.output.data(), fftBuffer.data() + partitionSize, sizeof(SampleType) * partitionSize);
+        std::memmove(state.frame.data(), state.frame.data() + partitionSize, sizeof(SampleType) * partitionSize);
+        state.position = 0;
+    }
+
+    juce::dsp::FFT fft;
+    DoubleFft doubleFft;
+    PrecisionState<float> floatState;
+    PrecisionState<double> doubleState;
+    int kernelIndex = 2;
+};
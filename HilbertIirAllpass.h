@@ -0,0 +1,190 @@
+// HilbertIirAllpass.h
+#pragma once
+#include <JuceHeader.h>
+#include "HilbertBackend.h"
+
+//==============================================================================
+// Low latency Hilbert engine: polyphase IIR allpass pair
+//
+// Two chains of four second-order allpass sections (Olli Niemitalo's design)
+// whose outputs stay 90 degrees apart to within 0.7 degrees from roughly
+// 0.0017 fs to 0.4983 fs. Each section is
+//
+//     y[n] = a^2 * (x[n] + y[n - 2]) - x[n - 2]
+//
+// so the pair costs eight sections per sample and adds no latency.
+//
+// Run at an oversampled rate, that band would start oversampling factor
+// times higher in Hz. setOversamplingFactor() maps every delay through the
+// allpass z^-1 -> (z^-1 - alpha) / (1 - alpha z^-1), alpha = (F - 1) / (F + 1),
+// which stretches low frequencies by F and so puts the band edge back where
+// it is at the base rate; the top of the audio band stays inside the
+// quadrature band. The sections become general second-order allpasses
+//
+//     y[n] = d2 * (x[n] - y[n - 2]) + d1 * (x[n - 1] - y[n - 1]) + x[n - 2]
+//
+// and the real chain's extra delay a first-order allpass.
+//==============================================================================
+class HilbertIirAllpass : public HilbertBackend
+{
+public:
+    HilbertIirAllpass()
+    {
+        setOversamplingFactor(1);
+    }
+
+    void prepare(int numChannels, int maxBlockSize) override
+    {
+        juce::ignoreUnused(maxBlockSize);
+        channels.resize(static_cast<size_t>(juce::jmax(1, numChannels)));
+        doubleChannels.resize(static_cast<size_t>(juce::jmax(1, numChannels)));
+        reset();
+    }
+
+    void reset() override
+    {
+        std::fill(channels.begin(), channels.end(), ChannelState<float>{});
+        std::fill(doubleChannels.begin(), doubleChannels.end(), ChannelState<double>{});
+    }
+
+    int getLatencySamples() const override { return 0; }
+
+    // The rate the pair runs at, as a multiple of the rate its band is meant
+    // for; clears the filter state on a change
+    void setOversamplingFactor(int factor)
+    {
+        if (factor == oversamplingFactor)
+            return;
+
+        oversamplingFactor = factor;
+        const double alpha = (factor - 1.0) / (factor + 1.0);
+        warpCoefficients(floatCoefficients, alpha);
+        warpCoefficients(doubleCoefficients, alpha);
+        reset();
+    }
+
+    void process(int channel, const float* input, float* real, float* imag, int numSamples) override
+    {
+        processChannel(channels, floatCoefficients, channel, input, real, imag, numSamples);
+    }
+
+    void process(int channel, const double* input, double* real, double* imag, int numSamples) override
+    {
+        processChannel(doubleChannels, doubleCoefficients, channel, input, real, imag, numSamples);
+    }
+
+    // Squared allpass coefficients (shared with BandSplitBank's per-band pairs)
+    static constexpr int numSections = 4;
+
+    template <typename SampleType>
+    static constexpr std::array<SampleType, numSections> realCoeffs{
+        static_cast<SampleType>(0.6923878 * 0.6923878),
+        static_cast<SampleType>(0.9360654322959 * 0.9360654322959),
+        static_cast<SampleType>(0.9882295226860 * 0.9882295226860),
+        static_cast<SampleType>(0.9987488452737 * 0.9987488452737)
+    };
+
+    template <typename SampleType>
+    static constexpr std::array<SampleType, numSections> imagCoeffs{
+        static_cast<SampleType>(0.4021921162426 * 0.4021921162426),
+        static_cast<SampleType>(0.8561710882420 * 0.8561710882420),
+        static_cast<SampleType>(0.9722909545651 * 0.9722909545651),
+        static_cast<SampleType>(0.9952884791278 * 0.9952884791278)
+    };
+
+private:
+    template <typename SampleType>
+    struct Section
+    {
+        SampleType x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+    };
+
+    template <typename SampleType>
+    struct ChannelState
+    {
+        std::array<Section<SampleType>, numSections> real;
+        std::array<Section<SampleType>, numSections> imag;
+        SampleType delayX1 = 0, delayY1 = 0;
+    };
+
+    template <typename SampleType>
+    struct ChainCoefficients
+    {
+        std::array<SampleType, numSections> d1{}, d2{};
+    };
+
+    template <typename SampleType>
+    struct Coefficients
+    {
+        ChainCoefficients<SampleType> real, imag;
+        SampleType delay = 0;  // alpha of the real chain's extra delay
+    };
+
+    // Substituting the first-order allpass into (a^2 - z^-2) / (1 - a^2 z^-2)
+    // gives minus the general section above, with d0 = 1 - a^2 alpha^2,
+    // d1 = -2 alpha (1 - a^2) / d0 and d2 = (alpha^2 - a^2) / d0. Both chains
+    // have four sections, so the signs cancel.
+    template <typename SampleType>
+    static void warpCoefficients(Coefficients<SampleType>& coefficients, double alpha)
+    {
+        auto warpChain = [alpha](ChainCoefficients<SampleType>& chain, const std::array<double, numSections>& squared)
+        {
+            for (size_t s = 0; s < numSections; ++s)
+            {
+                const double a2 = squared[s];
+                const double d0 = 1.0 - a2 * alpha * alpha;
+                chain.d1[s] = static_cast<SampleType>(-2.0 * alpha * (1.0 - a2) / d0);
+                chain.d2[s] = static_cast<SampleType>((alpha * alpha - a2) / d0);
+            }
+        };
+
+        warpChain(coefficients.real, realCoeffs<double>);
+        warpChain(coefficients.imag, imagCoeffs<double>);
+        coefficients.delay = static_cast<SampleType>(alpha);
+    }
+
+    template <typename SampleType>
+    static void processChannel(std::vector<ChannelState<SampleType>>& states, const Coefficients<SampleType>& coefficients,
+        int channel, const SampleType* input, SampleType* real, SampleType* imag, int numSamples)
+    {
+        jassert(juce::isPositiveAndBelow(channel, static_cast<int>(states.size())));
+        auto& state = states[static_cast<size_t>(channel)];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const SampleType x = input[i];
+
+            // The real chain carries the extra (allpass) delay
+            const SampleType u = processChain(state.real, coefficients.real, x);
+            real[i] = coefficients.delay * (state.delayY1 - u) + state.delayX1;
+            state.delayX1 = u;
+            state.delayY1 = real[i];
+            imag[i] = processChain(state.imag, coefficients.imag, x);
+        }
+    }
+
+    template <typename SampleType>
+    static SampleType processChain(std::array<Section<SampleType>, numSections>& sections,
+        const ChainCoefficients<SampleType>& coefficients, SampleType x)
+    {
+        for (size_t s = 0; s < numSections; ++s)
+        {
+            auto& section = sections[s];
+            const SampleType y = coefficients.d2[s] * (x - section.y2) + coefficients.d1[s] * (section.x1 - section.y1) + section.x2;
+
+            section.x2 = section.x1;
+            section.x1 = x;
+            section.y2 = section.y1;
+            section.y1 = y;
+            x = y;
+        }
+
+        return x;
+    }
+
+    std::vector<ChannelState<float>> channels;
+    std::vector<ChannelState<double>> doubleChannels;
+    Coefficients<float> floatCoefficients;
+    Coefficients<double> doubleCoefficients;
+    int oversamplingFactor = 0;
+};
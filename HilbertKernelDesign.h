@@ -0,0 +1,72 @@
+// HilbertKernelDesign.h
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+// Windowed ideal Hilbert transformer design, shared by every FIR engine
+//
+//     h[centre + k] = 2 / (pi k) * w[centre + k]   for odd k, 0 otherwise
+//
+// w is a Blackman window over numTaps + 2 points, so no tap is wasted on a
+// zero at either end. The same definition serves the compile-time kernels
+// of FixedHilbertFir and the long FFT kernels of HilbertFftConvolver, so
+// switching engines at a given length keeps the same ripple and bandwidth.
+//==============================================================================
+namespace HilbertKernelDesign
+{
+    // std::cos isn't constexpr before C++26: range reduction plus a Taylor
+    // series, accurate to double rounding
+    constexpr double cosine(double x)
+    {
+        constexpr double pi = 3.141592653589793238;
+        while (x > pi)
+            x -= 2.0 * pi;
+        while (x < -pi)
+            x += 2.0 * pi;
+
+        double term = 1.0;
+        double sum = 1.0;
+        for (int n = 1; n < 24; ++n)
+        {
+            term *= -x * x / static_cast<double>((2 * n - 1) * (2 * n));
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    // Window over numTaps + 2 points, so the outermost taps aren't zeroed
+    constexpr double blackman(int n, int numTaps)
+    {
+        constexpr double twoPi = 6.283185307179586477;
+        const double phase = twoPi * static_cast<double>(n + 1) / static_cast<double>(numTaps + 1);
+        return 0.42 - 0.5 * cosine(phase) + 0.08 * cosine(2.0 * phase);
+    }
+
+    // h[centre + k] of a numTaps long kernel, for odd k (even taps are zero)
+    constexpr double tapGain(int k, int numTaps)
+    {
+        constexpr double pi = 3.141592653589793238;
+        return 2.0 / (pi * k) * blackman(numTaps / 2 + k, numTaps);
+    }
+
+    struct TapPair
+    {
+        int offset;   // k, from the centre tap
+        double gain;  // h[centre + k] = -h[centre - k]
+    };
+
+    template <int numTaps>
+    constexpr std::array<TapPair, (numTaps / 2 + 1) / 2> designPairs()
+    {
+        std::array<TapPair, (numTaps / 2 + 1) / 2> pairs{};
+
+        for (size_t j = 0; j < pairs.size(); ++j)
+        {
+            const int k = 2 * static_cast<int>(j) + 1;
+            pairs[j] = { k, tapGain(k, numTaps) };
+        }
+
+        return pairs;
+    }
+}
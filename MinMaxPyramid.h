@@ -0,0 +1,103 @@
+// MinMaxPyramid.h
+#pragma once
+#include <JuceHeader.h>
+#include "ScopeFifo.h"
+
+//==============================================================================
+// Multi-resolution min/max history (like a waveform overview)
+//
+// Level 0 holds scope frames as they arrive; every level above merges pairs
+// of frames from the one below, so level L frames span 2^L base frames. A
+// view of any time span is read from the coarsest level that still has at
+// least one frame per pixel, which keeps drawing O(pixel width) whether the
+// span is a tenth of a second or 60 s.
+//==============================================================================
+class MinMaxPyramid
+{
+public:
+    explicit MinMaxPyramid(int baseCapacityFrames)
+    {
+        int capacity = juce::nextPowerOfTwo(juce::jmax(minLevelCapacity, baseCapacityFrames));
+
+        while (capacity >= minLevelCapacity)
+        {
+            levels.push_back({ std::vector<ScopeFrame>(static_cast<size_t>(capacity)), 0 });
+            capacity /= 2;
+        }
+    }
+
+    void push(const ScopeFrame& frame)
+    {
+        ScopeFrame merged = frame;
+
+        for (auto& level : levels)
+        {
+            level.frames[static_cast<size_t>(level.count & (level.frames.size() - 1))] = merged;
+            ++level.count;
+
+            // Only every second frame completes a pair for the next level
+            if ((level.count & 1) != 0)
+                break;
+
+            const auto& previous = level.frames[static_cast<size_t>((level.count - 2) & (level.frames.size() - 1))];
+            merged.envelopeMin = juce::jmin(merged.envelopeMin, previous.envelopeMin);
+            merged.envelopeMax = juce::jmax(merged.envelopeMax, previous.envelopeMax);
+            merged.peak = juce::jmax(merged.peak, previous.peak);
+        }
+    }
+
+    // Fills columns with the min/max of the most recent spanFrames base
+    // frames, split evenly across columns.size() pixels (oldest first).
+    // Anything older than the history reads as silence.
+    void read(double spanFrames, std::vector<ScopeFrame>& columns) const
+    {
+        const int width = static_cast<int>(columns.size());
+        if (width == 0)
+            return;
+
+        // Coarsest level that still has at least one frame per column
+        int levelIndex = 0;
+        while (levelIndex + 1 < static_cast<int>(levels.size())
+               && spanFrames / static_cast<double>(2 << levelIndex) >= width)
+            ++levelIndex;
+
+        const auto& level = levels[static_cast<size_t>(levelIndex)];
+        const double levelSpan = spanFrames / static_cast<double>(1 << levelIndex);
+        const double start = static_cast<double>(level.count) - levelSpan;
+        const auto oldest = static_cast<juce::int64>(level.count) - static_cast<juce::int64>(level.frames.size());
+
+        for (int x = 0; x < width; ++x)
+        {
+            const auto first = static_cast<juce::int64>(std::floor(start + levelSpan * x / width));
+            const auto last = juce::jmax(first + 1, static_cast<juce::int64>(std::floor(start + levelSpan * (x + 1) / width)));
+
+            ScopeFrame column{ 1.0f, 0.0f, 0.0f };
+            for (auto i = first; i < last; ++i)
+            {
+                if (i < 0 || i < oldest || i >= static_cast<juce::int64>(level.count))
+                {
+                    column.envelopeMin = 0.0f;
+                    continue;
+                }
+
+                const auto& frame = level.frames[static_cast<size_t>(i) & (level.frames.size() - 1)];
+                column.envelopeMin = juce::jmin(column.envelopeMin, frame.envelopeMin);
+                column.envelopeMax = juce::jmax(column.envelopeMax, frame.envelopeMax);
+                column.peak = juce::jmax(column.peak, frame.peak);
+            }
+
+            columns[static_cast<size_t>(x)] = column;
+        }
+    }
+
+private:
+    static constexpr int minLevelCapacity = 64;
+
+    struct Level
+    {
+        std::vector<ScopeFrame> frames;  // ring, power-of-two sized
+        juce::uint64 count;              // frames ever written to this level
+    };
+
+    std::vector<Level> levels;
+};
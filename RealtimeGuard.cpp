@@ -0,0 +1,45 @@
+// RealtimeGuard.cpp
+#include "RealtimeGuard.h"
+
+#if HILBERT_REALTIME_CHECKS
+
+namespace
+{
+    thread_local bool realtimeScope = false;
+    std::atomic<int> numViolations{ 0 };
+}
+
+RealtimeGuard::RealtimeGuard() noexcept : wasActive(realtimeScope)
+{
+    realtimeScope = true;
+}
+
+RealtimeGuard::~RealtimeGuard() noexcept
+{
+    realtimeScope = wasActive;
+}
+
+bool RealtimeGuard::isActive() noexcept
+{
+    return realtimeScope;
+}
+
+int RealtimeGuard::getNumViolations() noexcept
+{
+    return numViolations.load();
+}
+
+void RealtimeGuard::reportViolation(const char* what) noexcept
+{
+    // Leave the real-time scope while reporting: the logging allocates itself
+    const bool wasInScope = realtimeScope;
+    realtimeScope = false;
+
+    ++numViolations;
+    DBG("Real-time violation on the audio thread: " << what);
+    jassertfalse;
+
+    realtimeScope = wasInScope;
+}
+
+#endif
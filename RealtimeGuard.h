@@ -0,0 +1,68 @@
+// RealtimeGuard.h
+#pragma once
+#include <JuceHeader.h>
+
+// On by default in debug builds; define as 0 or 1 to override
+#ifndef HILBERT_REALTIME_CHECKS
+ #define HILBERT_REALTIME_CHECKS JUCE_DEBUG
+#endif
+
+// Set by Clang when building with -fsanitize=realtime
+#if defined (__has_feature)
+ #if __has_feature (realtime_sanitizer)
+  #define HILBERT_REALTIME_SANITIZER 1
+ #endif
+#endif
+
+#ifndef HILBERT_REALTIME_SANITIZER
+ #define HILBERT_REALTIME_SANITIZER 0
+#endif
+
+#if HILBERT_REALTIME_SANITIZER
+ #define HILBERT_NONBLOCKING [[clang::nonblocking]]
+#else
+ #define HILBERT_NONBLOCKING
+#endif
+
+//==============================================================================
+// Real-time safety checks for the audio thread
+//
+// The plugin itself is checked with Clang's RealtimeSanitizer: build with
+// -fsanitize=realtime and processBlock, which is declared HILBERT_NONBLOCKING,
+// aborts with a stack trace on any malloc, lock or blocking system call made
+// from inside it, in whatever host loads the plugin.
+//
+// RealtimeGuard marks the same scope for the offline tools. While one is
+// alive, any heap allocation or deallocation on its thread counts as a
+// violation: it is logged, trips a jassert and is counted for the tools to
+// report. Only operator new/delete are seen, through the replacements in
+// Tools/RealtimeAllocationHooks.cpp, which are linked into the tools and
+// never into the plugin. Without them, or unless HILBERT_REALTIME_CHECKS is
+// set, the guard does nothing.
+//
+// Nothing in the checked scope calls back into the host, so neither check
+// has exceptions: latency changes and output parameter values are left in
+// atomics and reported from the message thread.
+//==============================================================================
+class RealtimeGuard
+{
+public:
+#if HILBERT_REALTIME_CHECKS
+    RealtimeGuard() noexcept;
+    ~RealtimeGuard() noexcept;
+
+    static bool isActive() noexcept;
+    static int getNumViolations() noexcept;
+    static void reportViolation(const char* what) noexcept;
+
+private:
+    bool wasActive;
+#else
+    RealtimeGuard() noexcept {}
+
+    static bool isActive() noexcept { return false; }
+    static int getNumViolations() noexcept { return 0; }
+#endif
+
+    JUCE_DECLARE_NON_COPYABLE(RealtimeGuard)
+};
@@ -0,0 +1,112 @@
+// Saturation.h
+#pragma once
+#include <JuceHeader.h>
+#include "DspDispatch.h"
+
+//==============================================================================
+// Block tanh saturation
+//
+// fastTanh() is the [7/6] Pade approximant of tanh with its input clamped to
+// +/-4.79. Its absolute error is below 7.1e-5 over the whole real line and
+// its output never leaves [-1, 1]. There are no branches or libm calls, so
+// processBlock() auto-vectorises. Both work on float and double samples.
+// getFastTanhKernel() returns the fast loop built for the best instruction
+// set (see DspDispatch.h).
+//==============================================================================
+namespace Saturation
+{
+    enum Quality
+    {
+        reference = 0,    // std::tanh, two stages (the original signal path)
+        fast,             // fastTanh, two stages
+        fastSingleStage   // fastTanh, drive and final soft clip merged into one stage
+    };
+
+    inline const juce::StringArray& getQualityNames()
+    {
+        static const juce::StringArray names{ "Reference", "Fast", "Fast Single Stage" };
+        return names;
+    }
+
+    template <typename SampleType>
+    constexpr SampleType fastTanhLimit = static_cast<SampleType>(4.79);
+
+    // The Pade approximant alone, only valid for |x| <= fastTanhLimit
+    template <typename SampleType>
+    forcedinline SampleType fastTanhRational(SampleType x)
+    {
+        using T = SampleType;
+        const T x2 = x * x;
+        const T numerator = x * (static_cast<T>(135135) + x2 * (static_cast<T>(17325) + x2 * (static_cast<T>(378) + x2)));
+        const T denominator = static_cast<T>(135135) + x2 * (static_cast<T>(62370) + x2 * (static_cast<T>(3150) + x2 * static_cast<T>(28)));
+        return numerator / denominator;
+    }
+
+    template <typename SampleType>
+    forcedinline SampleType fastTanh(SampleType x)
+    {
+        return fastTanhRational(juce::jlimit(-fastTanhLimit<SampleType>, fastTanhLimit<SampleType>, x));
+    }
+
+    // Clamping in its own pass keeps both loops free of branches; fused, GCC
+    // folds the clamped constants through the rational and stops vectorising
+    template <typename SampleType>
+    forcedinline void fastTanhLoop(SampleType* data, int numSamples)
+    {
+        constexpr auto limit = fastTanhLimit<SampleType>;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const SampleType x = data[i] < -limit ? -limit : data[i];
+            data[i] = x > limit ? limit : x;
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = fastTanhRational(data[i]);
+    }
+
+    template <typename SampleType>
+    inline void processBlock(SampleType* data, int numSamples, bool useReference)
+    {
+        if (useReference)
+        {
+            for (int i = 0; i < numSamples; ++i)
+                data[i] = std::tanh(data[i]);
+        }
+        else
+        {
+            fastTanhLoop(data, numSamples);
+        }
+    }
+
+    template <typename SampleType>
+    using BlockKernel = void (*)(SampleType* data, int numSamples);
+
+    template <typename SampleType>
+    void fastTanhBaseline(SampleType* data, int numSamples) { fastTanhLoop(data, numSamples); }
+
+   #if HILBERT_DISPATCH_X86
+    template <typename SampleType>
+    HILBERT_TARGET_AVX2 void fastTanhAvx2(SampleType* data, int numSamples) { fastTanhLoop(data, numSamples); }
+
+    template <typename SampleType>
+    HILBERT_TARGET_AVX512 void fastTanhAvx512(SampleType* data, int numSamples) { fastTanhLoop(data, numSamples); }
+   #endif
+
+    template <typename SampleType>
+    BlockKernel<SampleType> getFastTanhKernel()
+    {
+       #if HILBERT_DISPATCH_X86
+        return DspDispatch::select<BlockKernel<SampleType>>({ fastTanhBaseline<SampleType>, fastTanhAvx2<SampleType>,
+                                                              fastTanhAvx512<SampleType> });
+       #else
+        return DspDispatch::select<BlockKernel<SampleType>>({ fastTanhBaseline<SampleType>, nullptr, nullptr });
+       #endif
+    }
+
+    // Number of tanh stages a modulated (non-sidechain) signal goes through
+    inline int getNumStages(int quality)
+    {
+        return quality == fastSingleStage ? 1 : 2;
+    }
+}
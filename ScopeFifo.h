@@ -0,0 +1,97 @@
+// ScopeFifo.h
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+// One decimated scope point: the envelope range and peak hold over a frame
+//==============================================================================
+struct ScopeFrame
+{
+    float envelopeMin = 0.0f;
+    float envelopeMax = 0.0f;
+    float peak = 0.0f;
+};
+
+//==============================================================================
+// Wait-free single-producer / single-consumer queue of scope frames
+//
+// The audio thread pushes one frame every getDecimation() samples; the editor
+// drains everything that has arrived on each timer tick. Nothing allocates
+// or locks after construction, and a full queue simply drops frames rather
+// than blocking the audio thread.
+//==============================================================================
+class ScopeFifo
+{
+public:
+    // About one frame per 6 samples at 48 kHz, so a scope a few hundred pixels
+    // wide still gets a frame per pixel at spans of a tenth of a second
+    static constexpr int framesPerSecond = 8000;
+    static constexpr int capacity = 8192;
+
+    // prepareToPlay, while nothing pushes; only touches the producer side,
+    // so the editor may keep draining
+    void prepare(double sampleRate)
+    {
+        decimation = juce::jmax(1, juce::roundToInt(sampleRate / framesPerSecond));
+        pendingCount = 0;
+    }
+
+    // Audio thread: accumulates one sample, pushing a frame once it is complete
+    void pushSample(float envelope, float peak)
+    {
+        if (pendingCount == 0)
+        {
+            pending.envelopeMin = envelope;
+            pending.envelopeMax = envelope;
+            pending.peak = peak;
+        }
+        else
+        {
+            pending.envelopeMin = juce::jmin(pending.envelopeMin, envelope);
+            pending.envelopeMax = juce::jmax(pending.envelopeMax, envelope);
+            pending.peak = juce::jmax(pending.peak, peak);
+        }
+
+        if (++pendingCount == decimation)
+        {
+            push(pending);
+            pendingCount = 0;
+        }
+    }
+
+    // Audio thread
+    bool push(const ScopeFrame& frame)
+    {
+        const auto scope = fifo.write(1);
+        if (scope.blockSize1 == 0)
+            return false;
+
+        frames[static_cast<size_t>(scope.startIndex1)] = frame;
+        return true;
+    }
+
+    // Message thread: hands every queued frame to callback, oldest first
+    template <typename Callback>
+    int drain(Callback&& callback)
+    {
+        const auto scope = fifo.read(fifo.getNumReady());
+
+        for (int i = 0; i < scope.blockSize1; ++i)
+            callback(frames[static_cast<size_t>(scope.startIndex1 + i)]);
+
+        for (int i = 0; i < scope.blockSize2; ++i)
+            callback(frames[static_cast<size_t>(scope.startIndex2 + i)]);
+
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+    int getDecimation() const { return decimation; }
+
+private:
+    juce::AbstractFifo fifo{ capacity };
+    std::array<ScopeFrame, capacity> frames;
+
+    ScopeFrame pending;
+    int pendingCount = 0;
+    int decimation = 22;
+};
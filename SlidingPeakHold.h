@@ -0,0 +1,109 @@
+// SlidingPeakHold.h
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+// Sliding-window maximum for hold-then-release peak detection
+//
+// Keeps a monotonic (decreasing) deque of granule maxima in a fixed ring, so
+// each sample costs O(1) amortised and nothing allocates after prepare().
+// The window is tracked in granules of maxHoldSamples / maxGranules samples
+// (about a millisecond at the longest hold), which keeps multi-second holds
+// at 192 kHz down to a few thousand entries. A hold of zero samples bypasses
+// the window entirely rather than holding for a granule. Inputs are assumed >= 0.
+//==============================================================================
+class SlidingPeakHold
+{
+public:
+    static constexpr int maxGranules = 4096;
+
+    void prepare(int maxHoldSamples)
+    {
+        granuleSize = juce::jmax(1, (maxHoldSamples + maxGranules - 1) / maxGranules);
+        entries.assign(maxGranules + 1, {});
+        reset();
+    }
+
+    void reset()
+    {
+        head = count = 0;
+        granuleIndex = 0;
+        granuleMax = 0.0f;
+        granuleFill = 0;
+    }
+
+    void setHoldSamples(int holdSamples)
+    {
+        // Start the window empty when a hold comes back
+        if (holdSamples <= 0 && !bypassed)
+            reset();
+
+        bypassed = holdSamples <= 0;
+        windowGranules = juce::jlimit(0, maxGranules, (holdSamples + granuleSize - 1) / granuleSize);
+        expire();
+    }
+
+    // Returns the maximum over the hold window, including this sample
+    float pushSample(float input)
+    {
+        if (bypassed)
+            return input;
+
+        granuleMax = juce::jmax(granuleMax, input);
+        const float windowMax = count > 0 ? juce::jmax(granuleMax, entries[static_cast<size_t>(head)].value)
+                                          : granuleMax;
+
+        if (++granuleFill == granuleSize)
+            pushGranule();
+
+        return windowMax;
+    }
+
+private:
+    struct Entry
+    {
+        float value = 0.0f;
+        juce::int64 granule = 0;
+    };
+
+    void pushGranule()
+    {
+        if (!entries.empty())
+        {
+            // Older granules that aren't larger can never be the maximum again
+            while (count > 0 && back().value <= granuleMax)
+                --count;
+
+            entries[static_cast<size_t>((head + count) % capacity())] = { granuleMax, granuleIndex };
+            ++count;
+        }
+
+        ++granuleIndex;
+        granuleMax = 0.0f;
+        granuleFill = 0;
+        expire();
+    }
+
+    // Drops granules that have slid out of the window
+    void expire()
+    {
+        while (count > 0 && entries[static_cast<size_t>(head)].granule + windowGranules < granuleIndex)
+        {
+            head = (head + 1) % capacity();
+            --count;
+        }
+    }
+
+    Entry& back() { return entries[static_cast<size_t>((head + count - 1) % capacity())]; }
+    int capacity() const { return static_cast<int>(entries.size()); }
+
+    std::vector<Entry> entries;
+    int head = 0;
+    int count = 0;
+    int granuleSize = 1;
+    int windowGranules = 0;
+    juce::int64 granuleIndex = 0;  // index of the granule being filled
+    float granuleMax = 0.0f;
+    int granuleFill = 0;
+    bool bypassed = false;
+};
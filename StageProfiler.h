@@ -0,0 +1,241 @@
+// StageProfiler.h
+#pragma once
+#include <JuceHeader.h>
+
+// On by default, release builds included; define as 0 to compile the timers out
+#ifndef HILBERT_STAGE_PROFILING
+ #define HILBERT_STAGE_PROFILING 1
+#endif
+
+//==============================================================================
+// Per-stage timing of processBlock
+//
+// ScopedTimers add the high resolution tick count spent in each stage to a
+// per-block total. At the end of the block the audio thread bins those
+// totals, and the whole block's time, into log-spaced histograms. About
+// every statsWindowSeconds of audio the histograms are reduced to
+// p50/p99/max and published through a triple buffer, so neither thread ever
+// waits on the other. The window then starts again, so the figures describe
+// the last few seconds rather than the whole session.
+//==============================================================================
+class StageProfiler
+{
+public:
+    enum Stage
+    {
+        hilbertStage = 0,  // analytic signal / band split
+        analysisStage,     // EnvelopeAnalyzer, and the band path's extra backend pass for it
+        smoothingStage,    // attack/release followers
+        peakStage,         // peak hold and metering
+        outputStage,       // dry delay, modulation and saturation
+        scopePushStage,    // scope frames and control-rate output
+        numStages
+    };
+
+    static constexpr int totalRow = numStages;  // snapshot row for the whole processBlock
+   #if HILBERT_STAGE_PROFILING
+    static constexpr bool isEnabled = true;
+   #else
+    static constexpr bool isEnabled = false;
+   #endif
+    static constexpr double statsWindowSeconds = 2.0;
+
+    static const juce::StringArray& getRowNames()
+    {
+        static const juce::StringArray names{ "Hilbert", "Analysis", "Smoothing", "Peak", "Output", "Scope", "Total" };
+        return names;
+    }
+
+    struct RowStats
+    {
+        float p50 = 0.0f;  // microseconds
+        float p99 = 0.0f;
+        float max = 0.0f;
+    };
+
+    struct Snapshot
+    {
+        std::array<RowStats, numStages + 1> rows;
+        float deadlineMicros = 0.0f;  // audio duration of the longest block in the window
+        int numBlocks = 0;
+    };
+
+#if HILBERT_STAGE_PROFILING
+    StageProfiler()
+    {
+        // Bin b holds durations up to minMicros * binRatio^(b + 1)
+        binRatio = std::pow(maxMicros / minMicros, 1.0 / static_cast<double>(numBins));
+        microsPerTick = 1.0e6 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+    }
+
+    // Not while processBlock can run
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        clearWindow();
+        stageTicks.fill(0);
+    }
+
+    // Audio thread, bracketing processBlock
+    void beginBlock()
+    {
+        stageTicks.fill(0);
+        blockStart = juce::Time::getHighResolutionTicks();
+    }
+
+    void endBlock(int numSamples)
+    {
+        const auto blockTicks = juce::Time::getHighResolutionTicks() - blockStart;
+
+        for (int stage = 0; stage < numStages; ++stage)
+            addToHistogram(stage, stageTicks[static_cast<size_t>(stage)]);
+        addToHistogram(totalRow, blockTicks);
+
+        windowDeadline = juce::jmax(windowDeadline, static_cast<double>(numSamples) * 1.0e6 / sampleRate);
+        ++windowBlocks;
+        windowSamples += numSamples;
+
+        if (static_cast<double>(windowSamples) >= statsWindowSeconds * sampleRate)
+        {
+            publish();
+            clearWindow();
+        }
+    }
+
+    // Audio thread: adds the lifetime of the timer to a stage
+    class ScopedTimer
+    {
+    public:
+        // A timer started inside another one takes its time out of the enclosing stage
+        ScopedTimer(StageProfiler& profilerToUse, Stage stageToTime) noexcept
+            : profiler(profilerToUse), stage(stageToTime), enclosingStage(profilerToUse.activeStage),
+              start(juce::Time::getHighResolutionTicks())
+        {
+            profiler.activeStage = stage;
+        }
+
+        ~ScopedTimer() noexcept
+        {
+            const juce::int64 elapsed = juce::Time::getHighResolutionTicks() - start;
+            profiler.stageTicks[static_cast<size_t>(stage)] += elapsed;
+            if (enclosingStage != numStages)
+                profiler.stageTicks[static_cast<size_t>(enclosingStage)] -= elapsed;
+            profiler.activeStage = enclosingStage;
+        }
+
+    private:
+        StageProfiler& profiler;
+        Stage stage;
+        Stage enclosingStage;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedTimer)
+    };
+
+    // Any thread but the audio thread: copies the newest snapshot into
+    // destination, returning false if nothing new was published since the last call
+    bool getLatestSnapshot(Snapshot& destination)
+    {
+        if ((middle.load() & newDataFlag) == 0)
+            return false;
+
+        front = middle.exchange(front) & indexMask;
+        destination = slots[static_cast<size_t>(front)];
+        return true;
+    }
+
+private:
+    static constexpr int numBins = 96;
+    static constexpr double minMicros = 0.1;
+    static constexpr double maxMicros = 1.0e5;
+    static constexpr int indexMask = 3;
+    static constexpr int newDataFlag = 4;
+
+    using Histogram = std::array<int, numBins>;
+
+    void addToHistogram(int row, juce::int64 ticks)
+    {
+        const double micros = static_cast<double>(ticks) * microsPerTick;
+        const int bin = micros <= minMicros ? 0
+                      : juce::jlimit(0, numBins - 1, static_cast<int>(std::log(micros / minMicros) / std::log(binRatio)));
+
+        ++histograms[static_cast<size_t>(row)][static_cast<size_t>(bin)];
+        windowMax[static_cast<size_t>(row)] = juce::jmax(windowMax[static_cast<size_t>(row)], micros);
+    }
+
+    // Upper edge of the bin holding the given fraction of the window's blocks
+    float getPercentile(const Histogram& histogram, double fraction) const
+    {
+        const int target = juce::jmax(1, static_cast<int>(std::ceil(fraction * windowBlocks)));
+        int count = 0;
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            count += histogram[static_cast<size_t>(bin)];
+            if (count >= target)
+                return static_cast<float>(minMicros * std::pow(binRatio, bin + 1));
+        }
+
+        return static_cast<float>(maxMicros);
+    }
+
+    void publish()
+    {
+        auto& snapshot = slots[static_cast<size_t>(back)];
+
+        for (size_t row = 0; row < histograms.size(); ++row)
+        {
+            // The bin edge can overshoot the exact maximum; never show p99 above it
+            const auto max = static_cast<float>(windowMax[row]);
+            snapshot.rows[row] = { juce::jmin(max, getPercentile(histograms[row], 0.5)),
+                                   juce::jmin(max, getPercentile(histograms[row], 0.99)), max };
+        }
+
+        snapshot.deadlineMicros = static_cast<float>(windowDeadline);
+        snapshot.numBlocks = windowBlocks;
+
+        back = middle.exchange(back | newDataFlag) & indexMask;
+    }
+
+    void clearWindow()
+    {
+        for (auto& histogram : histograms)
+            histogram.fill(0);
+
+        windowMax.fill(0.0);
+        windowDeadline = 0.0;
+        windowBlocks = 0;
+        windowSamples = 0;
+    }
+
+    // Audio thread
+    std::array<juce::int64, numStages> stageTicks{};
+    Stage activeStage = numStages;  // innermost running ScopedTimer, numStages for none
+    juce::int64 blockStart = 0;
+    std::array<Histogram, numStages + 1> histograms{};
+    std::array<double, numStages + 1> windowMax{};
+    double windowDeadline = 0.0;
+    int windowBlocks = 0;
+    juce::int64 windowSamples = 0;
+    double sampleRate = 44100.0;
+    double binRatio = 1.0;
+    double microsPerTick = 1.0;
+
+    // Triple buffer: the audio thread fills slots[back], then swaps it with
+    // middle; the reader swaps middle with slots[front] when it is flagged new
+    std::array<Snapshot, 3> slots;
+    int back = 0;
+    std::atomic<int> middle{ 1 };
+    int front = 2;
+#else
+    void prepare(double) {}
+    void beginBlock() {}
+    void endBlock(int) {}
+    bool getLatestSnapshot(Snapshot&) { return false; }
+
+    struct ScopedTimer
+    {
+        ScopedTimer(StageProfiler&, Stage) noexcept {}
+    };
+#endif
+};
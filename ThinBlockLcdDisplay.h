@@ -1,6 +1,7 @@
 // ThinBlockLcdDisplay.h
 #pragma once
 #include <JuceHeader.h>
+#include "CachedLayer.h"
 
 //==============================================================================
 // Thin Block LCD Display (For gain visualization)
@@ -8,61 +9,102 @@
 class ThinBlockLcdDisplay final : public juce::Component
 {
 public:
-    ThinBlockLcdDisplay() { setSize(100, 10); }
+    ThinBlockLcdDisplay()
+    {
+        setOpaque(true);
+        setSize(100, 10);
+    }
 
     void paint(juce::Graphics& g) override
     {
-        // LCD background
-        g.fillAll(juce::Colour(120, 140, 100));
-        g.setColour(juce::Colour(60, 70, 50));
-        g.drawRect(getLocalBounds(), 1);
-
-        // Draw blocks based on value
-        const int totalBlocks = 10;
-        const float blockWidth = static_cast<float>(getWidth() - 4) / totalBlocks;
-        const float blockHeight = static_cast<float>(getHeight() - 4);
-
-        // Calculate how many blocks to fill based on normalized value (0-1)
-        const int blocksToFill = juce::jlimit(0, totalBlocks,
-            static_cast<int>(std::round(value * totalBlocks)));
+        // LCD background (cached)
+        background.draw(g, *this, [this](juce::Graphics& layer) { paintBackground(layer); });
 
         // Draw filled blocks
         g.setColour(juce::Colour(20, 25, 15));
-        for (int i = 0; i < blocksToFill; ++i)
-        {
-            const float x = 2.0f + i * blockWidth;
-            g.fillRect(x, 2.0f, blockWidth - 1.0f, blockHeight);
-        }
+        for (int i = 0; i < filledBlocks; ++i)
+            g.fillRect(getBlockArea(i).withTrimmedRight(1.0f));
 
-        // Draw block separators
-        g.setColour(juce::Colour(60, 70, 50));
-        for (int i = 1; i < totalBlocks; ++i)
-        {
-            const float x = 2.0f + i * blockWidth;
-            g.drawLine(x, 2.0f, x, getHeight() - 2.0f, 0.5f);
-        }
+        // Draw block separators (cached)
+        separators.draw(g, *this, [this](juce::Graphics& layer) { paintSeparators(layer); });
 
         // Draw value text at the end
         g.setColour(juce::Colour(20, 25, 15));
         g.setFont(juce::FontOptions(juce::Font::getDefaultMonospacedFontName(), 8.0f, juce::Font::plain));
-        g.drawText(valueText, getWidth() - 35, 1, 33, getHeight() - 2, juce::Justification::right, false);
+        g.drawText(valueText, getTextArea(), juce::Justification::right, false);
+    }
+
+    void resized() override
+    {
+        background.invalidate();
+        separators.invalidate();
     }
 
     void setValue(float normalizedValue)
     {
         value = juce::jlimit(0.0f, 1.0f, normalizedValue);
-        repaint();
+
+        // Calculate how many blocks to fill based on normalized value (0-1)
+        const int blocksToFill = juce::jlimit(0, totalBlocks,
+            static_cast<int>(std::round(value * totalBlocks)));
+
+        if (blocksToFill == filledBlocks)
+            return;
+
+        // Only the blocks that changed state need repainting
+        const auto changed = getBlockArea(juce::jmin(blocksToFill, filledBlocks))
+            .getUnion(getBlockArea(juce::jmax(blocksToFill, filledBlocks) - 1));
+        filledBlocks = blocksToFill;
+        repaint(changed.getSmallestIntegerContainer());
     }
 
     void setValueText(const juce::String& text)
     {
+        if (text == valueText)
+            return;
+
         valueText = text;
-        repaint();
+        repaint(getTextArea());
     }
 
 private:
+    static constexpr int totalBlocks = 10;
+
+    juce::Rectangle<float> getBlockArea(int index) const
+    {
+        const float blockWidth = static_cast<float>(getWidth() - 4) / totalBlocks;
+        const float blockHeight = static_cast<float>(getHeight() - 4);
+        return { 2.0f + index * blockWidth, 2.0f, blockWidth, blockHeight };
+    }
+
+    juce::Rectangle<int> getTextArea() const
+    {
+        return { getWidth() - 35, 1, 33, getHeight() - 2 };
+    }
+
+    void paintBackground(juce::Graphics& g)
+    {
+        g.fillAll(juce::Colour(120, 140, 100));
+        g.setColour(juce::Colour(60, 70, 50));
+        g.drawRect(getLocalBounds(), 1);
+    }
+
+    void paintSeparators(juce::Graphics& g)
+    {
+        g.setColour(juce::Colour(60, 70, 50));
+        for (int i = 1; i < totalBlocks; ++i)
+        {
+            const float x = getBlockArea(i).getX();
+            g.drawLine(x, 2.0f, x, getHeight() - 2.0f, 0.5f);
+        }
+    }
+
     float value = 0.0f;
+    int filledBlocks = 0;
     juce::String valueText;
 
+    CachedLayer background;
+    CachedLayer separators;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ThinBlockLcdDisplay)
-};
\ No newline at end of file
+};
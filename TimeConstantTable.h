@@ -0,0 +1,50 @@
+// TimeConstantTable.h
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+// Cached time constant -> one-pole coefficient table
+//
+// Holds exp(-1 / (t * sampleRate)) for log-spaced times between minTimeMs and
+// maxTimeMs, so parameter changes only cost a lookup and a linear
+// interpolation. The table is rebuilt only when the sample rate changes.
+//==============================================================================
+class TimeConstantTable
+{
+public:
+    static constexpr float minTimeMs = 1.0f;
+    static constexpr float maxTimeMs = 20000.0f;  // 10x the longest release, for the peak hold
+    static constexpr int tableSize = 1024;
+
+    void prepare(double newSampleRate)
+    {
+        if (newSampleRate == tableSampleRate)
+            return;
+
+        tableSampleRate = newSampleRate;
+
+        for (int i = 0; i < tableSize; ++i)
+        {
+            const double timeS = minTimeMs * 0.001 * std::exp(i * logStep);
+            table[static_cast<size_t>(i)] = static_cast<float>(std::exp(-1.0 / (timeS * tableSampleRate)));
+        }
+    }
+
+    float getCoefficient(float timeMs) const
+    {
+        jassert(tableSampleRate > 0.0);
+
+        const float position = static_cast<float>(std::log(juce::jlimit(minTimeMs, maxTimeMs, timeMs) / minTimeMs) / logStep);
+        const int index = juce::jlimit(0, tableSize - 2, static_cast<int>(position));
+        const float fraction = position - static_cast<float>(index);
+
+        return table[static_cast<size_t>(index)]
+             + fraction * (table[static_cast<size_t>(index + 1)] - table[static_cast<size_t>(index)]);
+    }
+
+private:
+    static constexpr double logStep = 9.903487552536127 / (tableSize - 1);  // ln(maxTimeMs / minTimeMs)
+
+    std::array<float, tableSize> table{};
+    double tableSampleRate = 0.0;
+};
@@ -0,0 +1,417 @@
+// Main.cpp - Hilbert Envelope DSP benchmark
+//
+// Console app that times HilbertEnvelopeProcessor::processBlock across modes,
+// block sizes, sample rates and channel counts, and reports ns/sample,
+// cycles/sample (x86 TSC) and real-time factor. Build it as a JUCE console
+// application that also compiles the plugin sources and
+// Tools/RealtimeAllocationHooks.cpp, the same way as Tools/HilbertEnvelopeRender.
+//
+// Usage:
+//   HilbertEnvelopeBench [--quick] [--seconds=<audio seconds per case>]
+//                        [--engine=<index>] [--variant=<index>] [--json=<file>]
+//   HilbertEnvelopeBench --compare-variants
+//
+// --json writes every case as a JSON array so results can be diffed between
+// commits; without it a table is printed. Debug builds exit with an error if
+// processBlock allocated (see RealtimeGuard.h).
+//
+// --variant forces one of the DspDispatch kernel builds (0 = baseline,
+// 1 = AVX2, 2 = AVX-512) instead of the best one for this CPU.
+// --compare-variants renders the same noise through every build this CPU
+// supports, in every mode and both precisions, and exits with an error if
+// any differs from the baseline by more than rounding. It also checks every
+// Quality kernel of the Standard engine, in every build, against its scalar
+// processReference() path.
+#include <JuceHeader.h>
+#include "../../HilbertEnvelopeProcessor.h"
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+namespace
+{
+    struct BenchCase
+    {
+        int mode;
+        int blockSize;
+        double sampleRate;
+        int numChannels;
+    };
+
+    struct BenchResult
+    {
+        double nsPerSample = 0.0;
+        double cyclesPerSample = 0.0;  // 0 where no cycle counter is available
+        double realTimeFactor = 0.0;   // audio time / processing time
+    };
+
+    juce::uint64 readCycleCounter()
+    {
+       #if JUCE_INTEL
+        return __rdtsc();
+       #else
+        return 0;
+       #endif
+    }
+
+    void setParameter(HilbertEnvelopeProcessor& processor, const juce::String& id, float value)
+    {
+        if (auto* parameter = dynamic_cast<juce::RangedAudioParameter*>(processor.getValueTreeState().getParameter(id)))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    // Main bus only, the sidechain key stays disconnected
+    bool setMainLayout(HilbertEnvelopeProcessor& processor, int numChannels)
+    {
+        const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+        if (processor.setBusesLayout({ { channelSet, juce::AudioChannelSet::disabled() }, { channelSet } }))
+            return true;
+
+        std::cerr << "Unsupported channel count (" << numChannels << ")" << std::endl;
+        return false;
+    }
+
+    bool runCase(const BenchCase& benchCase, double audioSeconds, int engine, BenchResult& result)
+    {
+        HilbertEnvelopeProcessor processor;
+        if (!setMainLayout(processor, benchCase.numChannels))
+            return false;
+
+        setParameter(processor, "mode", static_cast<float>(benchCase.mode));
+        setParameter(processor, "engine", static_cast<float>(engine));
+        processor.prepareToPlay(benchCase.sampleRate, benchCase.blockSize);
+
+        // White noise at a realistic level, copied in before every block
+        juce::Random random(0x5eed);
+        juce::AudioBuffer<float> source(benchCase.numChannels, benchCase.blockSize);
+        for (int ch = 0; ch < benchCase.numChannels; ++ch)
+            for (int i = 0; i < benchCase.blockSize; ++i)
+                source.setSample(ch, i, (random.nextFloat() * 2.0f - 1.0f) * 0.3f);
+
+        juce::AudioBuffer<float> buffer(benchCase.numChannels, benchCase.blockSize);
+        juce::MidiBuffer midi;
+        midi.ensureSize(HilbertEnvelopeProcessor::maxMidiOutputBytes);
+
+        const auto numBlocks = juce::jmax<juce::int64>(16,
+            static_cast<juce::int64>(audioSeconds * benchCase.sampleRate) / benchCase.blockSize);
+
+        // Warm up caches and branch predictors
+        for (int i = 0; i < 8; ++i)
+        {
+            buffer.makeCopyOf(source, true);
+            midi.clear();
+            processor.processBlock(buffer, midi);
+        }
+
+        juce::int64 ticks = 0;
+        juce::uint64 cycles = 0;
+
+        for (juce::int64 block = 0; block < numBlocks; ++block)
+        {
+            buffer.makeCopyOf(source, true);
+            midi.clear();
+
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            const auto startCycles = readCycleCounter();
+            processor.processBlock(buffer, midi);
+            cycles += readCycleCounter() - startCycles;
+            ticks += juce::Time::getHighResolutionTicks() - startTicks;
+        }
+
+        processor.releaseResources();
+
+        const double seconds = juce::Time::highResolutionTicksToSeconds(ticks);
+        const double channelSamples = static_cast<double>(numBlocks) * benchCase.blockSize * benchCase.numChannels;
+        const double audioTime = static_cast<double>(numBlocks) * benchCase.blockSize / benchCase.sampleRate;
+
+        result.nsPerSample = seconds * 1.0e9 / channelSamples;
+        result.cyclesPerSample = static_cast<double>(cycles) / channelSamples;
+        result.realTimeFactor = seconds > 0.0 ? audioTime / seconds : 0.0;
+        return true;
+    }
+
+    juce::var toVar(const BenchCase& benchCase, const BenchResult& result, int engine)
+    {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("mode", juce::StringArray{ "Instant", "Smoothed", "Sidechain" }[benchCase.mode]);
+        object->setProperty("engine", engine);
+        object->setProperty("variant", DspDispatch::getVariantName(DspDispatch::getActiveVariant()));
+        object->setProperty("blockSize", benchCase.blockSize);
+        object->setProperty("sampleRate", benchCase.sampleRate);
+        object->setProperty("channels", benchCase.numChannels);
+        object->setProperty("nsPerSample", result.nsPerSample);
+        object->setProperty("cyclesPerSample", result.cyclesPerSample);
+        object->setProperty("realTimeFactor", result.realTimeFactor);
+        return juce::var(object);
+    }
+
+    // Every channel of a few seconds of noise through one mode, in the
+    // requested precision, with the currently forced kernel build
+    template <typename SampleType>
+    bool renderForComparison(int mode, juce::AudioBuffer<SampleType>& output)
+    {
+        constexpr int numChannels = 16;  // enough for the widest follower lanes
+        constexpr int blockSize = 512;
+        constexpr int numBlocks = 200;
+
+        HilbertEnvelopeProcessor processor;
+        if (!setMainLayout(processor, numChannels))
+            return false;
+
+        processor.setProcessingPrecision(std::is_same_v<SampleType, double> ? juce::AudioProcessor::doublePrecision
+                                                                             : juce::AudioProcessor::singlePrecision);
+        setParameter(processor, "mode", static_cast<float>(mode));
+        processor.prepareToPlay(48000.0, blockSize);
+
+        juce::Random random(0x5eed);
+        output.setSize(numChannels, blockSize * numBlocks);
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < output.getNumSamples(); ++i)
+                output.setSample(ch, i, static_cast<SampleType>((random.nextFloat() * 2.0f - 1.0f) * 0.5f));
+
+        juce::MidiBuffer midi;
+        midi.ensureSize(HilbertEnvelopeProcessor::maxMidiOutputBytes);
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            juce::AudioBuffer<SampleType> view(output.getArrayOfWritePointers(), numChannels, block * blockSize, blockSize);
+            midi.clear();
+            processor.processBlock(view, midi);
+        }
+
+        processor.releaseResources();
+        return true;
+    }
+
+    template <typename SampleType>
+    double getMaxDifference(const juce::AudioBuffer<SampleType>& a, const juce::AudioBuffer<SampleType>& b)
+    {
+        double maxDifference = 0.0;
+        for (int ch = 0; ch < a.getNumChannels(); ++ch)
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                maxDifference = juce::jmax(maxDifference, std::abs(static_cast<double>(a.getSample(ch, i) - b.getSample(ch, i))));
+
+        return maxDifference;
+    }
+
+    // Builds may differ by FMA contraction and vector reduction order only
+    template <typename SampleType>
+    bool compareVariants(int mode, double tolerance)
+    {
+        DspDispatch::forceVariant(DspDispatch::baseline);
+        juce::AudioBuffer<SampleType> reference, output;
+        bool passed = renderForComparison(mode, reference);
+        if (!passed)
+        {
+            DspDispatch::clearForcedVariant();
+            return false;
+        }
+
+        for (int v = DspDispatch::baseline + 1; v < DspDispatch::numVariants; ++v)
+        {
+            const auto variant = static_cast<DspDispatch::Variant>(v);
+            if (!DspDispatch::isSupported(variant))
+                continue;
+
+            DspDispatch::forceVariant(variant);
+            if (!renderForComparison(mode, output))
+            {
+                passed = false;
+                break;
+            }
+
+            const double difference = getMaxDifference(reference, output);
+            const bool ok = difference <= tolerance;
+            passed = passed && ok;
+
+            std::cout << juce::String(juce::StringArray{ "Instant", "Smoothed", "Sidechain" }[mode]).paddedRight(' ', 10)
+                      << juce::String(std::is_same_v<SampleType, double> ? "double" : "float").paddedRight(' ', 8)
+                      << DspDispatch::getVariantName(variant).paddedRight(' ', 9)
+                      << "max difference " << juce::String(difference, 10)
+                      << (ok ? "" : "  FAILED") << std::endl;
+        }
+
+        DspDispatch::clearForcedVariant();
+        return passed;
+    }
+
+    // One fixed kernel's process() against its processReference(), fed the
+    // same noise in uneven blocks so chunk boundaries and history carry over
+    template <int NumTaps, typename SampleType>
+    double compareKernelToReference()
+    {
+        constexpr int numChannels = 2;
+        constexpr int numSamples = 48000;
+        constexpr int maxBlockSize = 700;
+
+        FixedHilbertFir<NumTaps> kernel, reference;
+        kernel.prepare(numChannels, maxBlockSize);
+        reference.prepare(numChannels, maxBlockSize);
+
+        juce::Random random(0x5eed);
+        std::vector<SampleType> input(numSamples), real(numSamples), imag(numSamples), referenceReal(numSamples), referenceImag(numSamples);
+        double maxDifference = 0.0;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            for (auto& sample : input)
+                sample = static_cast<SampleType>((random.nextFloat() * 2.0f - 1.0f) * 0.5f);
+
+            for (int start = 0; start < numSamples;)
+            {
+                const int n = juce::jmin(numSamples - start, 1 + random.nextInt(maxBlockSize));
+                kernel.process(ch, input.data() + start, real.data() + start, imag.data() + start, n);
+                reference.processReference(ch, input.data() + start, referenceReal.data() + start, referenceImag.data() + start, n);
+                start += n;
+            }
+
+            for (int i = 0; i < numSamples; ++i)
+                maxDifference = juce::jmax(maxDifference,
+                                           std::abs(static_cast<double>(real[static_cast<size_t>(i)] - referenceReal[static_cast<size_t>(i)])),
+                                           std::abs(static_cast<double>(imag[static_cast<size_t>(i)] - referenceImag[static_cast<size_t>(i)])));
+        }
+
+        return maxDifference;
+    }
+
+    template <typename SampleType>
+    bool compareKernelsToReference(double tolerance)
+    {
+        bool passed = true;
+
+        for (int v = DspDispatch::baseline; v < DspDispatch::numVariants; ++v)
+        {
+            const auto variant = static_cast<DspDispatch::Variant>(v);
+            if (!DspDispatch::isSupported(variant))
+                continue;
+
+            DspDispatch::forceVariant(variant);
+            using HilbertKernelDesign::kernelTapCounts;
+            const std::array<double, kernelTapCounts.size()> differences{
+                compareKernelToReference<kernelTapCounts[0], SampleType>(),
+                compareKernelToReference<kernelTapCounts[1], SampleType>(),
+                compareKernelToReference<kernelTapCounts[2], SampleType>(),
+                compareKernelToReference<kernelTapCounts[3], SampleType>(),
+                compareKernelToReference<kernelTapCounts[4], SampleType>(),
+                compareKernelToReference<kernelTapCounts[5], SampleType>(),
+                compareKernelToReference<kernelTapCounts[6], SampleType>()
+            };
+
+            for (size_t kernel = 0; kernel < differences.size(); ++kernel)
+            {
+                const bool ok = differences[kernel] <= tolerance;
+                passed = passed && ok;
+
+                std::cout << (juce::String(kernelTapCounts[kernel]) + " Taps").paddedRight(' ', 10)
+                          << juce::String(std::is_same_v<SampleType, double> ? "double" : "float").paddedRight(' ', 8)
+                          << DspDispatch::getVariantName(variant).paddedRight(' ', 9)
+                          << "max difference from reference " << juce::String(differences[kernel], 10)
+                          << (ok ? "" : "  FAILED") << std::endl;
+            }
+        }
+
+        DspDispatch::clearForcedVariant();
+        return passed;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    const juce::ArgumentList args(argc, argv);
+
+    const bool quick = args.containsOption("--quick");
+    const double audioSeconds = args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue()
+                                                                 : (quick ? 0.25 : 2.0);
+    const int engine = args.getValueForOption("--engine").getIntValue();
+    const auto jsonFile = args.containsOption("--json") ? args.getFileForOption("--json") : juce::File();
+
+    if (args.containsOption("--compare-variants"))
+    {
+        std::cout << "Baseline: " << DspDispatch::getVariantName(DspDispatch::baseline)
+                  << ", best: " << DspDispatch::getVariantName(DspDispatch::getBestVariant()) << std::endl;
+
+        bool passed = true;
+        for (int mode = 0; mode < 3; ++mode)
+        {
+            passed = compareVariants<float>(mode, 1.0e-5) && passed;
+            passed = compareVariants<double>(mode, 1.0e-12) && passed;
+        }
+
+        passed = compareKernelsToReference<float>(1.0e-5) && passed;
+        passed = compareKernelsToReference<double>(1.0e-12) && passed;
+
+        return passed ? 0 : 1;
+    }
+
+    if (args.containsOption("--variant"))
+    {
+        const auto variant = static_cast<DspDispatch::Variant>(args.getValueForOption("--variant").getIntValue());
+        if (!DspDispatch::isSupported(variant))
+        {
+            std::cerr << "Kernel variant " << static_cast<int>(variant) << " isn't supported here" << std::endl;
+            return 1;
+        }
+
+        DspDispatch::forceVariant(variant);
+    }
+
+    const juce::Array<int> blockSizes = quick ? juce::Array<int>{ 64, 512, 4096 }
+                                              : juce::Array<int>{ 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    const juce::Array<double> sampleRates = quick ? juce::Array<double>{ 48000.0, 192000.0 }
+                                                  : juce::Array<double>{ 44100.0, 48000.0, 96000.0, 192000.0, 384000.0 };
+    const juce::Array<int> channelCounts = quick ? juce::Array<int>{ 1, 2, 16 }
+                                                 : juce::Array<int>{ 1, 2, 6, 8, 12, 16 };
+
+    juce::Array<juce::var> results;
+
+    if (jsonFile == juce::File())
+        std::cout << "Kernels: " << DspDispatch::getVariantName(DspDispatch::getActiveVariant()) << std::endl
+                  << "mode       block  rate      ch   ns/sample  cycles/sample  RT factor" << std::endl;
+
+    for (int mode = 0; mode < 3; ++mode)
+        for (auto blockSize : blockSizes)
+            for (auto sampleRate : sampleRates)
+                for (auto numChannels : channelCounts)
+                {
+                    const BenchCase benchCase{ mode, blockSize, sampleRate, numChannels };
+                    BenchResult result;
+                    if (!runCase(benchCase, audioSeconds, engine, result))
+                        return 1;
+
+                    results.add(toVar(benchCase, result, engine));
+
+                    if (jsonFile == juce::File())
+                    {
+                        std::cout << juce::String(juce::StringArray{ "Instant", "Smoothed", "Sidechain" }[mode]).paddedRight(' ', 10)
+                                  << juce::String(blockSize).paddedLeft(' ', 6)
+                                  << juce::String(sampleRate, 0).paddedLeft(' ', 8)
+                                  << juce::String(numChannels).paddedLeft(' ', 5)
+                                  << juce::String(result.nsPerSample, 2).paddedLeft(' ', 12)
+                                  << juce::String(result.cyclesPerSample, 1).paddedLeft(' ', 15)
+                                  << juce::String(result.realTimeFactor, 1).paddedLeft(' ', 11) << std::endl;
+                    }
+                }
+
+    // Debug builds count every allocation made inside processBlock
+    if (RealtimeGuard::getNumViolations() > 0)
+    {
+        std::cerr << RealtimeGuard::getNumViolations() << " allocations inside processBlock" << std::endl;
+        return 1;
+    }
+
+    if (jsonFile != juce::File())
+    {
+        if (!jsonFile.replaceWithText(juce::JSON::toString(juce::var(results))))
+        {
+            std::cerr << "Can't write " << jsonFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,349 @@
+// Main.cpp - Hilbert Envelope offline renderer
+//
+// Console app that streams audio files through HilbertEnvelopeProcessor with
+// no editor, writing the processed audio and/or the raw detector envelope.
+// Build it as a JUCE console application that also compiles the plugin
+// sources (HilbertEnvelopeProcessor.cpp, HilbertEnvelopeEditor.cpp) with
+// juce_audio_formats, juce_audio_processors and juce_dsp, plus
+// Tools/RealtimeAllocationHooks.cpp for the debug allocation checks.
+//
+// Usage:
+//   HilbertEnvelopeRender [options] <input files...>
+//
+//   --out <dir>          output directory (default: next to each input)
+//   --audio              write <name>.processed.wav (default if nothing else is chosen)
+//   --envelope           write <name>.envelope.wav (32-bit float, one channel per input channel)
+//   --analysis           write <name>.analysis.bin (see below)
+//   --state <file>       load parameters from a getStateInformation() blob
+//   --param <id>=<value> set a parameter in its own units (choices by index); repeatable
+//   --block <samples>    processing block size (default 8192)
+//   --threads <n>        files rendered in parallel (default: number of CPU cores)
+//
+// Inputs whose outputs would land on the same name (same file name from
+// different folders with --out, or the same file twice) are rejected up front.
+//
+// The analysis sidecar holds the EnvelopeAnalyzer frames of the first detector
+// channel (with bands > 1, the broadband analytic signal of the first input
+// channel), little endian:
+//
+//   header  "HEAF", uint32 version (1), float64 sample rate, uint32 hop size
+//   frame   int64 position, int32 onset offset (-1 = none), float32 onset
+//           strength (dB), rms, peak, crest factor, frequency (Hz)
+//
+// Positions are input sample indices, so they line up with the audio.
+#include <JuceHeader.h>
+#include "../../HilbertEnvelopeProcessor.h"
+
+namespace
+{
+    struct RenderSettings
+    {
+        juce::File outputDirectory;
+        bool writeAudio = false;
+        bool writeEnvelope = false;
+        bool writeAnalysis = false;
+        juce::MemoryBlock state;
+        juce::StringPairArray parameters;
+        int blockSize = 8192;
+        int numThreads = juce::SystemStats::getNumCpus();
+    };
+
+    // A file to render: the reader and a configured processor, set up on the
+    // main thread and then handed to a pool thread
+    struct RenderJob
+    {
+        juce::File input;
+        std::unique_ptr<juce::AudioFormatReader> reader;
+        std::unique_ptr<HilbertEnvelopeProcessor> processor;
+    };
+
+    // <output directory>/<input name without extension>, which the outputs append their suffix to
+    juce::File getOutputStem(const juce::File& input, const RenderSettings& settings)
+    {
+        const auto directory = settings.outputDirectory == juce::File() ? input.getParentDirectory()
+                                                                        : settings.outputDirectory;
+        return directory.getChildFile(input.getFileNameWithoutExtension());
+    }
+
+    // Parameter changes go through setValueNotifyingHost (as the APVTS does
+    // for state too), so this runs on the main thread, never from the pool
+    void applyParameters(HilbertEnvelopeProcessor& processor, const RenderSettings& settings)
+    {
+        if (settings.state.getSize() > 0)
+            processor.setStateInformation(settings.state.getData(), static_cast<int>(settings.state.getSize()));
+
+        auto& apvts = processor.getValueTreeState();
+
+        for (auto& id : settings.parameters.getAllKeys())
+        {
+            if (auto* parameter = dynamic_cast<juce::RangedAudioParameter*>(apvts.getParameter(id)))
+                parameter->setValueNotifyingHost(parameter->convertTo0to1(settings.parameters[id].getFloatValue()));
+            else
+                std::cerr << "Unknown parameter: " << id << std::endl;
+        }
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> createWriter(const juce::File& file, double sampleRate, int numChannels)
+    {
+        file.deleteFile();
+        auto stream = file.createOutputStream();
+        if (stream == nullptr)
+            return {};
+
+        // 32-bit WAV is written as IEEE float; on success the writer owns the stream
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(
+            wav.createWriterFor(stream.get(), sampleRate, static_cast<unsigned int>(numChannels), 32, {}, 0));
+
+        if (writer != nullptr)
+            stream.release();
+
+        return writer;
+    }
+
+    std::unique_ptr<juce::FileOutputStream> createAnalysisWriter(const juce::File& file, const EnvelopeAnalyzer& analyzer)
+    {
+        file.deleteFile();
+        auto stream = file.createOutputStream();
+        if (stream == nullptr)
+            return {};
+
+        stream->write("HEAF", 4);
+        stream->writeInt(1);
+        stream->writeDouble(analyzer.getSampleRate());
+        stream->writeInt(analyzer.getHopSize());
+        return stream;
+    }
+
+    void writeAnalysisFrame(juce::OutputStream& stream, const AnalysisFrame& frame)
+    {
+        stream.writeInt64(frame.position);
+        stream.writeInt(frame.onsetOffset);
+        stream.writeFloat(frame.onsetStrength);
+        stream.writeFloat(frame.rms);
+        stream.writeFloat(frame.peak);
+        stream.writeFloat(frame.crestFactor);
+        stream.writeFloat(frame.frequency);
+    }
+
+    std::unique_ptr<RenderJob> createJob(const juce::File& input, const RenderSettings& settings,
+                                         juce::AudioFormatManager& formats)
+    {
+        auto job = std::make_unique<RenderJob>();
+        job->input = input;
+        job->reader.reset(formats.createReaderFor(input));
+        if (job->reader == nullptr)
+        {
+            std::cerr << "Can't read " << input.getFullPathName() << std::endl;
+            return {};
+        }
+
+        const int numChannels = static_cast<int>(job->reader->numChannels);
+        const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+
+        // Main bus only, the sidechain key stays disconnected
+        job->processor = std::make_unique<HilbertEnvelopeProcessor>();
+        if (!job->processor->setBusesLayout({ { channelSet, juce::AudioChannelSet::disabled() }, { channelSet } }))
+        {
+            std::cerr << "Unsupported channel count (" << numChannels << ") in " << input.getFileName() << std::endl;
+            return {};
+        }
+
+        applyParameters(*job->processor, settings);
+        return job;
+    }
+
+    bool renderFile(RenderJob& job, const RenderSettings& settings)
+    {
+        const auto& input = job.input;
+        auto& reader = job.reader;
+        auto& processor = *job.processor;
+        const int numChannels = static_cast<int>(reader->numChannels);
+
+        processor.setNonRealtime(true);
+        processor.prepareToPlay(reader->sampleRate, settings.blockSize);
+
+        const auto stem = getOutputStem(input, settings).getFullPathName();
+
+        std::unique_ptr<juce::AudioFormatWriter> audioWriter, envelopeWriter;
+        if (settings.writeAudio)
+            audioWriter = createWriter(juce::File(stem + ".processed.wav"), reader->sampleRate, numChannels);
+        if (settings.writeEnvelope)
+            envelopeWriter = createWriter(juce::File(stem + ".envelope.wav"), reader->sampleRate, numChannels);
+
+        std::unique_ptr<juce::FileOutputStream> analysisWriter;
+        if (settings.writeAnalysis)
+            analysisWriter = createAnalysisWriter(juce::File(stem + ".analysis.bin"), processor.getEnvelopeAnalyzer());
+
+        if ((settings.writeAudio && audioWriter == nullptr) || (settings.writeEnvelope && envelopeWriter == nullptr)
+            || (settings.writeAnalysis && analysisWriter == nullptr))
+        {
+            std::cerr << "Can't write output for " << input.getFileName() << std::endl;
+            processor.releaseResources();
+            return false;
+        }
+
+        juce::AudioBuffer<float> buffer(numChannels, settings.blockSize);
+        juce::AudioBuffer<float> envelope(numChannels, settings.blockSize);
+        juce::MidiBuffer midi;
+        midi.ensureSize(HilbertEnvelopeProcessor::maxMidiOutputBytes);
+        processor.setEnvelopeCapture(&envelope);
+
+        // Run the latency worth of silence past the end and drop it from the
+        // start, so the outputs line up with the input file. The audio is
+        // delayed by the full reported latency (detector, lookahead and output
+        // oversampling); the envelope only by the detector
+        const juce::int64 latency = processor.getLatencySamples();
+        const juce::int64 envelopeLatency = processor.getEnvelopeLatencySamples();
+        const juce::int64 totalLength = reader->lengthInSamples + latency;
+        juce::int64 audioSkip = latency;
+        juce::int64 envelopeSkip = envelopeLatency;
+        juce::int64 envelopeRemaining = reader->lengthInSamples;
+
+        for (juce::int64 position = 0; position < totalLength; position += settings.blockSize)
+        {
+            const int numSamples = static_cast<int>(juce::jmin<juce::int64>(settings.blockSize, totalLength - position));
+            buffer.clear();
+            reader->read(&buffer, 0, numSamples, position, true, true);
+
+            // The processor may add envelope CCs; nothing reads them here
+            midi.clear();
+            processor.processBlock(buffer, midi);
+
+            // Frames come out as the blocks are processed; drop the ones from
+            // before the file start (the latency prelude) and past its end
+            processor.getEnvelopeAnalyzer().drain([&](const AnalysisFrame& frame)
+            {
+                if (analysisWriter != nullptr && frame.position >= 0 && frame.position < reader->lengthInSamples)
+                    writeAnalysisFrame(*analysisWriter, frame);
+            });
+
+            const int audioOffset = static_cast<int>(juce::jmin<juce::int64>(audioSkip, numSamples));
+            audioSkip -= audioOffset;
+
+            if (audioWriter != nullptr && audioOffset < numSamples)
+                audioWriter->writeFromAudioSampleBuffer(buffer, audioOffset, numSamples - audioOffset);
+
+            // The envelope reaches the end of the file sooner; stop it there
+            const int envelopeOffset = static_cast<int>(juce::jmin<juce::int64>(envelopeSkip, numSamples));
+            const int envelopeLength = static_cast<int>(juce::jmin<juce::int64>(envelopeRemaining, numSamples - envelopeOffset));
+            envelopeSkip -= envelopeOffset;
+            envelopeRemaining -= envelopeLength;
+
+            if (envelopeWriter != nullptr && envelopeLength > 0)
+                envelopeWriter->writeFromAudioSampleBuffer(envelope, envelopeOffset, envelopeLength);
+        }
+
+        processor.setEnvelopeCapture(nullptr);
+        processor.releaseResources();
+
+        std::cout << "Rendered " << input.getFileName() << std::endl;
+        return true;
+    }
+
+    bool parseArguments(const juce::ArgumentList& args, RenderSettings& settings, juce::Array<juce::File>& inputs)
+    {
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+            const bool hasValue = i + 1 < args.size();
+
+            if (arg == "--out" && hasValue)
+                settings.outputDirectory = args[++i].resolveAsFile();
+            else if (arg == "--audio")
+                settings.writeAudio = true;
+            else if (arg == "--envelope")
+                settings.writeEnvelope = true;
+            else if (arg == "--analysis")
+                settings.writeAnalysis = true;
+            else if (arg == "--state" && hasValue)
+                args[++i].resolveAsFile().loadFileAsData(settings.state);
+            else if (arg == "--param" && hasValue)
+            {
+                const auto assignment = args[++i].text;
+                settings.parameters.set(assignment.upToFirstOccurrenceOf("=", false, false),
+                                        assignment.fromFirstOccurrenceOf("=", false, false));
+            }
+            else if (arg == "--block" && hasValue)
+                settings.blockSize = juce::jmax(16, args[++i].text.getIntValue());
+            else if (arg == "--threads" && hasValue)
+                settings.numThreads = juce::jmax(1, args[++i].text.getIntValue());
+            else if (arg.isLongOption() || arg.isShortOption())
+                return false;
+            else
+                inputs.add(arg.resolveAsFile());
+        }
+
+        if (!settings.writeAudio && !settings.writeEnvelope && !settings.writeAnalysis)
+            settings.writeAudio = true;
+
+        return !inputs.isEmpty();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    RenderSettings settings;
+    juce::Array<juce::File> inputs;
+
+    if (!parseArguments(juce::ArgumentList(argc, argv), settings, inputs))
+    {
+        std::cerr << "Usage: HilbertEnvelopeRender [--out dir] [--audio] [--envelope] [--analysis] [--state file]\n"
+                     "                            [--param id=value]... [--block n] [--threads n] files..."
+                  << std::endl;
+        return 1;
+    }
+
+    if (settings.outputDirectory != juce::File())
+        settings.outputDirectory.createDirectory();
+
+    // Outputs are named after the input file alone, so two inputs with the
+    // same name would write (and race on) the same files
+    juce::Array<juce::File> stems;
+    for (auto& input : inputs)
+    {
+        const auto stem = getOutputStem(input, settings);
+        const int other = stems.indexOf(stem);
+        if (other >= 0)
+        {
+            std::cerr << "Both " << inputs[other].getFullPathName() << " and " << input.getFullPathName()
+                      << " would write to " << stem.getFullPathName() << ".*" << std::endl;
+            return 1;
+        }
+        stems.add(stem);
+    }
+
+    std::atomic<int> failures{ 0 };
+    const int numThreads = juce::jmin(settings.numThreads, inputs.size());
+    juce::ThreadPool pool(numThreads);
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    // Readers and processors are set up here on the main thread, a few
+    // files ahead of the pool so they don't all sit in memory at once
+    for (auto& input : inputs)
+    {
+        while (pool.getNumJobs() >= 2 * numThreads)
+            juce::Thread::sleep(20);
+
+        std::shared_ptr<RenderJob> job = createJob(input, settings, formats);
+        if (job == nullptr)
+        {
+            ++failures;
+            continue;
+        }
+
+        pool.addJob([job, &settings, &failures]
+        {
+            if (!renderFile(*job, settings))
+                ++failures;
+        });
+    }
+
+    while (pool.getNumJobs() > 0)
+        juce::Thread::sleep(20);
+
+    return failures == 0 ? 0 : 1;
+}
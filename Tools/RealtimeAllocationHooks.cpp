@@ -0,0 +1,85 @@
+// RealtimeAllocationHooks.cpp
+//
+// Tools only: compile this into HilbertEnvelopeBench and HilbertEnvelopeRender,
+// never into the plugin. Replacing the global operator new/delete is only
+// dependable in an executable that links it statically; in a plugin loaded
+// by a host the calls may bind to the C++ runtime's versions instead, and
+// memory could cross between the host's allocator and ours. The plugin is
+// checked with RealtimeSanitizer instead (see RealtimeGuard.h).
+#include "../RealtimeGuard.h"
+
+#if HILBERT_REALTIME_CHECKS
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    void checkAllocation(const char* what) noexcept
+    {
+        if (RealtimeGuard::isActive())
+            RealtimeGuard::reportViolation(what);
+    }
+
+    void* allocateAligned(std::size_t size, std::size_t alignment) noexcept
+    {
+        size = juce::jmax<std::size_t>(1, size);
+
+       #if JUCE_WINDOWS
+        return _aligned_malloc(size, alignment);
+       #else
+        void* memory = nullptr;
+        return posix_memalign(&memory, juce::jmax(alignment, sizeof(void*)), size) == 0 ? memory : nullptr;
+       #endif
+    }
+
+    void freeAligned(void* memory) noexcept
+    {
+       #if JUCE_WINDOWS
+        _aligned_free(memory);
+       #else
+        std::free(memory);
+       #endif
+    }
+}
+
+//==============================================================================
+// Global allocation hooks. The array, nothrow and sized forms of the standard
+// library forward to these.
+void* operator new(std::size_t size)
+{
+    checkAllocation("operator new");
+
+    if (auto* memory = std::malloc(juce::jmax<std::size_t>(1, size)))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    if (memory != nullptr)
+        checkAllocation("operator delete");
+
+    std::free(memory);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    checkAllocation("operator new");
+
+    if (auto* memory = allocateAligned(size, static_cast<std::size_t>(alignment)))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+    if (memory != nullptr)
+        checkAllocation("operator delete");
+
+    freeAligned(memory);
+}
+
+#endif